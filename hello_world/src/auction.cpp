@@ -0,0 +1,195 @@
+#include "ap_int.h"
+#include "cost_type.h"
+
+// Largest matrix held on chip; must match AUCTION_MAX_SIZE in
+// opencl_backend.h.
+#define MAX_SIZE 256
+// Rows bidding at once, one per lane. Row r always bids in lane
+// r % BIDDERS, so the lanes read disjoint banks of the matrix.
+#define BIDDERS 8
+#define LANE_ROWS (MAX_SIZE / BIDDERS)
+
+extern "C" {
+
+// One epsilon phase of the auction algorithm on the reduced matrix
+// (dense, rows size apart, size up to MAX_SIZE), minimizing the cost.
+//
+// Every row starts unassigned. Each round, every lane takes one of its
+// unassigned rows and scans all columns in parallel with the other lanes,
+// one column per cycle, for the best and second best cost + price; the
+// row bids for its best column, raising the price by the difference plus
+// epsilon. Bids on the same column are resolved by comparators across
+// the lanes, the highest bid (then the lowest lane) winning; the column's
+// previous owner and the losing rows go back to their lane's queue. The
+// phase ends when every row holds a column: the assignment is then within
+// size * epsilon of the optimum.
+//
+// prices carries the column prices from phase to phase (zeroed first
+// when reset_prices); assignment receives the column of every row.
+void auction_kernel(
+    const cost_t *matrix,
+    cost_t *prices,
+    int *assignment,
+    ap_uint<32> size,
+    double epsilon,
+    bool reset_prices
+) {
+#pragma HLS INTERFACE m_axi port = matrix offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = prices offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = assignment offset = slave bundle = gmem
+#pragma HLS INTERFACE s_axilite port = size bundle = control
+#pragma HLS INTERFACE s_axilite port = epsilon bundle = control
+#pragma HLS INTERFACE s_axilite port = reset_prices bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    static cost_t local[MAX_SIZE][MAX_SIZE];
+#pragma HLS ARRAY_PARTITION variable = local cyclic factor = BIDDERS dim = 1
+    cost_t price[MAX_SIZE];
+    int owner[MAX_SIZE];
+    int row_col[MAX_SIZE];
+    // Unassigned rows of every lane, as circular queues.
+    int queue[BIDDERS][LANE_ROWS];
+#pragma HLS ARRAY_PARTITION variable = queue complete dim = 1
+    int head[BIDDERS], count[BIDDERS];
+#pragma HLS ARRAY_PARTITION variable = head complete
+#pragma HLS ARRAY_PARTITION variable = count complete
+
+    const cost_t eps = epsilon;
+
+    load_rows: for (ap_uint<32> row = 0; row < size; row++) {
+        load_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+            local[row][col] = matrix[row * size + col];
+        }
+    }
+    load_prices: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+        price[col] = reset_prices ? cost_t(0) : prices[col];
+        owner[col] = -1;
+    }
+    init_lanes: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+        head[lane] = 0;
+        count[lane] = 0;
+    }
+    init_queues: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+        const int lane = row % BIDDERS;
+        queue[lane][count[lane]] = row;
+        count[lane]++;
+        row_col[row] = -1;
+    }
+
+    rounds: while (true) {
+        int bidder[BIDDERS];
+        bool active[BIDDERS];
+#pragma HLS ARRAY_PARTITION variable = bidder complete
+#pragma HLS ARRAY_PARTITION variable = active complete
+        bool any = false;
+        take: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+            active[lane] = count[lane] > 0;
+            bidder[lane] = active[lane] ? queue[lane][head[lane]] : lane;
+            if (active[lane]) {
+                head[lane] = (head[lane] + 1) % LANE_ROWS;
+                count[lane]--;
+            }
+            any = any || active[lane];
+        }
+        if (!any) {
+            break;
+        }
+
+        // Best and second best cost + price of every bidding row
+        cost_t best[BIDDERS], second[BIDDERS];
+        int best_col[BIDDERS];
+        bool has_second[BIDDERS];
+#pragma HLS ARRAY_PARTITION variable = best complete
+#pragma HLS ARRAY_PARTITION variable = second complete
+#pragma HLS ARRAY_PARTITION variable = best_col complete
+#pragma HLS ARRAY_PARTITION variable = has_second complete
+        init_scan: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+            best[lane] = 0;
+            second[lane] = 0;
+            best_col[lane] = 0;
+            has_second[lane] = false;
+        }
+        scan: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+            const cost_t col_price = price[col];
+            lanes: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+                const cost_t value = local[bidder[lane]][col] + col_price;
+                if (col == 0 || value < best[lane]) {
+                    second[lane] = best[lane];
+                    has_second[lane] = col != 0;
+                    best[lane] = value;
+                    best_col[lane] = col;
+                } else if (!has_second[lane] || value < second[lane]) {
+                    second[lane] = value;
+                    has_second[lane] = true;
+                }
+            }
+        }
+
+        // The new price each row offers for its best column; with a
+        // single column there is no second best and it rises by epsilon.
+        cost_t bid[BIDDERS];
+#pragma HLS ARRAY_PARTITION variable = bid complete
+        bids: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+            const cost_t gap = has_second[lane] ? cost_t(second[lane] - best[lane]) : cost_t(0);
+            bid[lane] = price[best_col[lane]] + gap + eps;
+        }
+
+        bool wins[BIDDERS];
+#pragma HLS ARRAY_PARTITION variable = wins complete
+        resolve: for (int lane = 0; lane < BIDDERS; lane++) {
+#pragma HLS UNROLL
+            wins[lane] = active[lane];
+            compare: for (int other = 0; other < BIDDERS; other++) {
+#pragma HLS UNROLL
+                const bool outbid = bid[other] > bid[lane] || (bid[other] == bid[lane] && other < lane);
+                if (other != lane && active[other] && best_col[other] == best_col[lane] && outbid) {
+                    wins[lane] = false;
+                }
+            }
+        }
+
+        // Winners take their column (distinct columns, so the order does
+        // not matter); displaced owners and losers queue up again.
+        apply: for (int lane = 0; lane < BIDDERS; lane++) {
+            if (!active[lane]) {
+                continue;
+            }
+            int requeue = bidder[lane];
+            if (wins[lane]) {
+                const int col = best_col[lane];
+                requeue = owner[col];
+                owner[col] = bidder[lane];
+                row_col[bidder[lane]] = col;
+                price[col] = bid[lane];
+            }
+            if (requeue >= 0) {
+                const int home = requeue % BIDDERS;
+                queue[home][(head[home] + count[home]) % LANE_ROWS] = requeue;
+                count[home]++;
+                row_col[requeue] = -1;
+            }
+        }
+    }
+
+    store: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+        prices[i] = price[i];
+        assignment[i] = row_col[i];
+    }
+}
+
+}
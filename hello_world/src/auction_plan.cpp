@@ -0,0 +1,13 @@
+#include "auction_plan.h"
+
+#include <algorithm>
+
+std::vector<double> epsilon_schedule(double max_cost, size_t n, double unit, double factor) {
+    const double final_epsilon = std::max(unit / (n + 1), cost_resolution(max_cost));
+    std::vector<double> schedule;
+    for (double epsilon = max_cost / 2; epsilon > final_epsilon; epsilon /= factor) {
+        schedule.push_back(epsilon);
+    }
+    schedule.push_back(final_epsilon);
+    return schedule;
+}
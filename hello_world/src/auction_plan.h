@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cost_type.h"
+
+#include <cstddef>
+#include <vector>
+
+// Smallest epsilon auction_kernel can still raise a price by on costs up
+// to max_cost: the step of the fixed point types, or for the floating
+// point ones a few units in the last place of the prices, which stay
+// within a small multiple of max_cost.
+inline double cost_resolution(double max_cost) {
+#if COST_TYPE == COST_INT32
+    (void)max_cost;
+    return 1;
+#elif COST_TYPE == COST_FIXED
+    (void)max_cost;
+    return 1.0 / (1 << (COST_FIXED_W - COST_FIXED_I));
+#elif COST_TYPE == COST_FLOAT
+    return max_cost / (1 << 20);
+#else
+    return max_cost / (uint64_t(1) << 48);
+#endif
+}
+
+// cost_t units to one cost unit, given the CostQuantizer's scale: only
+// int32 costs are scaled, ap_fixed keeps its own binary point.
+inline double cost_unit(double scale) {
+#if COST_TYPE == COST_INT32
+    return scale;
+#else
+    (void)scale;
+    return 1;
+#endif
+}
+
+// Epsilon of every auction_kernel phase on an n x n problem whose reduced
+// costs lie between 0 and max_cost, in device units (unit device units
+// to one cost unit): from max_cost / 2, divided by factor each phase,
+// down to unit / (n + 1), which makes the assignment optimal when the
+// costs are whole units, though never below cost_resolution(max_cost).
+// The last phase bounds the assignment to n * epsilon above the optimum.
+std::vector<double> epsilon_schedule(double max_cost, size_t n, double unit, double factor = 4);
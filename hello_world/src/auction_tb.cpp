@@ -0,0 +1,174 @@
+// C simulation testbench: runs auction_kernel as a plain C++ function
+// behind the host solver, with the host's epsilon scaling (see
+// auction_plan.h), and checks the cost of every assignment against the
+// CPU reference. The costs are integers, exact in every COST_TYPE, and
+// the last epsilon makes the auction optimal on them unless the cost type
+// can't resolve it (float, on the large costs): the cost must then be
+// within n * epsilon of the optimum. Ties may pick other assignments of
+// the same cost, so only the costs are compared.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "ap_int.h"
+#include "auction_plan.h"
+#include "cost_quantizer.h"
+#include "cost_type.h"
+#include "cpu_backend.h"
+#include "munkres_context.h"
+
+extern "C" {
+void auction_kernel(const cost_t *matrix, cost_t *prices, int *assignment, ap_uint<32> size, double epsilon,
+                    bool reset_prices);
+}
+
+// Largest matrix auction_kernel holds; see opencl_backend.h.
+const size_t AUCTION_MAX_SIZE = 256;
+
+// The kernel's view of a value in device memory: ap_fixed is stored as
+// its raw bits.
+static cost_t kernel_cost(device_cost_t stored) {
+#if COST_TYPE == COST_FIXED
+    return cost_t(std::ldexp(static_cast<double>(stored), -(COST_FIXED_W - COST_FIXED_I)));
+#else
+    return stored;
+#endif
+}
+
+// The CPU backend with steps 2 to 5 replaced by the auction, quantized
+// and scaled as OpenClBackend does.
+class CsimAuctionBackend : public CpuBackend {
+public:
+    const char *name() const override { return "auction"; }
+
+    void reduce(bool rows_first) override {
+        CpuBackend::reduce(rows_first);
+        m_quantizer.set_scale(state());
+        m_quantized.resize(state().size * state().size);
+        m_quantizer.quantize(state(), m_quantized.data(), true);
+    }
+
+    bool solve_from_stars(int *stars) override {
+        const MunkresState &s = state();
+        if (s.size > AUCTION_MAX_SIZE) {
+            return false;
+        }
+        const double unit = cost_unit(m_quantizer.scale());
+        std::vector<cost_t> device(s.size * s.size);
+        double largest = 0;
+        for (size_t i = 0; i < device.size(); i++) {
+            device[i] = kernel_cost(m_quantized[i]);
+            largest = std::max(largest, s.matrix.data[i]);
+        }
+        std::vector<cost_t> prices(s.size);
+        const std::vector<double> schedule = epsilon_schedule(largest * unit, s.size, unit);
+        for (size_t phase = 0; phase < schedule.size(); phase++) {
+            auction_kernel(device.data(), prices.data(), stars, s.size, schedule[phase], phase == 0);
+        }
+        m_phases += schedule.size();
+        m_bound = s.size * schedule.back() / unit;
+        return true;
+    }
+
+    size_t phases() const { return m_phases; }
+    // How far above the optimum the last assignment may be
+    double bound() const { return m_bound; }
+
+private:
+    CostQuantizer m_quantizer;
+    std::vector<device_cost_t> m_quantized;
+    size_t m_phases = 0;
+    double m_bound = 0;
+};
+
+static double assignment_cost(const std::vector<double> &costs, const std::vector<double> &solution) {
+    double total = 0;
+    for (size_t i = 0; i < costs.size(); i++) {
+        if (solution[i] == 0) {
+            total += costs[i];
+        }
+    }
+    return total;
+}
+
+// Every row and column of the smaller side assigned exactly once
+static bool is_assignment(const std::vector<double> &solution, size_t rows, size_t columns) {
+    std::vector<int> row_count(rows), col_count(columns);
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < columns; col++) {
+            if (solution[row * columns + col] == 0) {
+                row_count[row]++;
+                col_count[col]++;
+            }
+        }
+    }
+    const size_t assigned = std::min(rows, columns);
+    for (size_t row = 0; row < rows; row++) {
+        if (row_count[row] > 1 || (rows <= columns && row_count[row] != 1)) {
+            return false;
+        }
+    }
+    for (size_t col = 0; col < columns; col++) {
+        if (col_count[col] > 1 || (columns <= rows && col_count[col] != 1)) {
+            return false;
+        }
+    }
+    return assigned > 0;
+}
+
+int main() {
+    struct Case {
+        size_t rows, columns;
+        int range;      // values are drawn from [0, range): small ranges give many ties
+        bool infinite;  // sprinkle infinities
+    };
+    const Case cases[] = {
+        {1, 1, 10, false},     {2, 2, 3, false},      {5, 5, 100, false},   {9, 9, 2, false},
+        {10, 10, 1000, false}, {16, 16, 4, false},    {37, 37, 500, false}, {20, 35, 50, false},
+        {35, 20, 50, false},   {64, 64, 10, true},    {100, 100, 1000, false}, {200, 200, 10000, false},
+        {256, 256, 100, false},  {150, 256, 100000, false},
+    };
+
+    MunkresContext reference(std::unique_ptr<SolverBackend>(new CpuBackend()));
+    std::unique_ptr<CsimAuctionBackend> backend(new CsimAuctionBackend());
+    CsimAuctionBackend &auction_backend = *backend;
+    MunkresContext auction(std::move(backend));
+
+    std::mt19937 generator(46);
+    bool valid = true;
+    for (const Case &c : cases) {
+        std::uniform_int_distribution<int> value(0, c.range - 1);
+        std::vector<double> costs(c.rows * c.columns);
+        for (size_t i = 0; i < costs.size(); i++) {
+            costs[i] = value(generator);
+            if (c.infinite && i % 7 == 3) {
+                costs[i] = std::numeric_limits<double>::infinity();
+            }
+        }
+
+        std::vector<double> expected = costs;
+        reference.solve(expected.data(), c.rows, c.columns);
+        std::vector<double> result = costs;
+        const size_t phases = auction_backend.phases();
+        auction.solve(result.data(), c.rows, c.columns);
+
+        const double cost = assignment_cost(costs, result);
+        const double optimum = assignment_cost(costs, expected);
+        const bool same = is_assignment(result, c.rows, c.columns) && cost >= optimum &&
+                          (cost == optimum || cost - optimum <= auction_backend.bound());
+        std::cout << c.rows << "x" << c.columns << " auction (" << auction_backend.phases() - phases
+                  << " phases): cost " << cost << (same ? " within " : " not within ") << auction_backend.bound()
+                  << " of the CPU reference " << optimum << std::endl;
+        valid = valid && same;
+    }
+
+    std::cout << "Cost type: " << COST_NAME << std::endl;
+    std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#include "batch_dispatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+BatchDispatcher::BatchDispatcher(OpenClDevice &device, int cus)
+    : m_units(std::max(cus, 1)) {
+    cl_int err;
+    OCL_CHECK(err, m_q = cl::CommandQueue(device.context, device.device,
+                                          CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err));
+
+    const size_t elements = BATCH_CAPACITY * BATCH_MAX_SIZE * BATCH_MAX_SIZE;
+    for (size_t cu = 0; cu < m_units.size(); cu++) {
+        Unit &unit = m_units[cu];
+        // A single unit takes whichever compute unit XRT picks
+        const int instance = m_units.size() == 1 ? -1 : static_cast<int>(cu);
+        unit.kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("munkres_batch_kernel", instance).c_str(),
+                                 &err);
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Batching needs munkres_batch_kernel in the xclbin");
+        }
+
+        unit.matrices.resize(elements);
+        unit.sizes.resize(BATCH_CAPACITY);
+        unit.offsets.resize(BATCH_CAPACITY);
+        unit.stars.resize(BATCH_CAPACITY * BATCH_MAX_SIZE);
+        OCL_CHECK(err, unit.matrices_buffer = cl::Buffer(device.context, CL_MEM_READ_ONLY,
+            sizeof(device_cost_t) * elements, nullptr, &err));
+        OCL_CHECK(err, unit.sizes_buffer = cl::Buffer(device.context, CL_MEM_READ_ONLY,
+            sizeof(cl_uint) * BATCH_CAPACITY, nullptr, &err));
+        OCL_CHECK(err, unit.offsets_buffer = cl::Buffer(device.context, CL_MEM_READ_ONLY,
+            sizeof(cl_uint) * BATCH_CAPACITY, nullptr, &err));
+        OCL_CHECK(err, unit.stars_buffer = cl::Buffer(device.context, CL_MEM_READ_WRITE,
+            sizeof(cl_int) * BATCH_CAPACITY * BATCH_MAX_SIZE, nullptr, &err));
+
+        OCL_CHECK(err, err = unit.kernel.setArg(0, unit.matrices_buffer));
+        OCL_CHECK(err, err = unit.kernel.setArg(1, unit.sizes_buffer));
+        OCL_CHECK(err, err = unit.kernel.setArg(2, unit.offsets_buffer));
+        OCL_CHECK(err, err = unit.kernel.setArg(3, unit.stars_buffer));
+    }
+}
+
+void BatchDispatcher::collect(Unit &unit, const std::vector<AssignmentProblem> &problems,
+                              std::vector<std::vector<double>> &solutions) {
+    cl_int err;
+    OCL_CHECK(err, err = unit.read.wait());
+    m_write_ns += elapsed_ns(unit.write, "transfer", "write");
+    m_kernel_ns += elapsed_ns(unit.run, "kernel", "munkres_batch_kernel");
+    m_read_ns += elapsed_ns(unit.read, "transfer", "read");
+
+    BatchPacker::unpack(problems, *unit.batch, unit.stars.data(), solutions);
+    m_solved += unit.batch->size();
+    unit.batch = nullptr;
+}
+
+void BatchDispatcher::solve(const std::vector<AssignmentProblem> &problems,
+                            std::vector<std::vector<double>> &solutions, std::vector<size_t> &large) {
+    cl_int err;
+    solutions.resize(problems.size());
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<Batch> batches = plan_batches(problems, large);
+
+    for (size_t b = 0; b < batches.size(); b++) {
+        Unit &unit = m_units[b % m_units.size()];
+        if (unit.batch) {
+            collect(unit, problems, solutions);
+        }
+
+        const Batch &batch = batches[b];
+        m_packer.pack(problems, batch, unit.matrices.data(), unit.sizes.data(), unit.offsets.data(),
+                      unit.stars.data());
+        const size_t last = batch.size() - 1;
+        const size_t elements = unit.offsets[last] + unit.sizes[last] * unit.sizes[last];
+        OCL_CHECK(err, err = unit.kernel.setArg(4, static_cast<cl_uint>(batch.size())));
+
+        // Only the packed part of each buffer crosses the bus. The copies
+        // do not block: the unit's host vectors stay untouched until it is
+        // collected.
+        std::vector<cl::Event> writes(4);
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(unit.matrices_buffer, CL_FALSE, 0,
+                                                    sizeof(device_cost_t) * elements, unit.matrices.data(),
+                                                    nullptr, &writes[0]));
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(unit.sizes_buffer, CL_FALSE, 0, sizeof(cl_uint) * batch.size(),
+                                                    unit.sizes.data(), nullptr, &writes[1]));
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(unit.offsets_buffer, CL_FALSE, 0, sizeof(cl_uint) * batch.size(),
+                                                    unit.offsets.data(), nullptr, &writes[2]));
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(unit.stars_buffer, CL_FALSE, 0,
+                                                    sizeof(cl_int) * BATCH_MAX_SIZE * batch.size(),
+                                                    unit.stars.data(), nullptr, &writes[3]));
+        unit.write = writes[0];
+        OCL_CHECK(err, err = m_q.enqueueTask(unit.kernel, &writes, &unit.run));
+        std::vector<cl::Event> run_done{unit.run};
+        OCL_CHECK(err, err = m_q.enqueueReadBuffer(unit.stars_buffer, CL_FALSE, 0,
+                                                   sizeof(cl_int) * BATCH_MAX_SIZE * batch.size(),
+                                                   unit.stars.data(), &run_done, &unit.read));
+        OCL_CHECK(err, err = m_q.flush());
+        unit.batch = &batch;
+        m_launches++;
+    }
+
+    // Drain the units oldest first
+    for (size_t b = batches.size() > m_units.size() ? batches.size() - m_units.size() : 0; b < batches.size(); b++) {
+        Unit &unit = m_units[b % m_units.size()];
+        if (unit.batch) {
+            collect(unit, problems, solutions);
+        }
+    }
+
+    m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchDispatcher::report(std::ostream &out) const {
+    out << "Batch: " << m_solved << " matrices in " << m_launches << " launches on " << m_units.size()
+        << " compute units, " << (m_launches ? double(m_solved) / m_launches : 0) << " per launch, "
+        << (m_seconds > 0 ? m_solved / m_seconds : 0) << " matrices/s" << std::endl;
+    out << "Busy time: matrix write " << m_write_ns / 1000000.0 << " ms, kernel " << m_kernel_ns / 1000000.0
+        << " ms, read " << m_read_ns / 1000000.0 << " ms, wall " << m_seconds * 1000 << " ms" << std::endl;
+    out << "Cost type: " << COST_NAME << ", largest quantization error: " << quantization_error() << std::endl;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "batch_plan.h"
+#include "opencl_backend.h"
+
+#include <vector>
+
+// Solves many small problems with munkres_batch_kernel: plan_batches bins
+// them by size, batch b goes to compute unit b % cus, and the solutions
+// are gathered back in input order. Each compute unit owns its buffers,
+// so the write, kernel and read of one unit overlap those of the others
+// on an out of order queue; a unit is reused once its read has completed.
+class BatchDispatcher {
+public:
+    BatchDispatcher(OpenClDevice &device, int cus = 1);
+
+    // solutions[i] receives problem i solved as MunkresContext::solve()
+    // leaves it, for every problem that fits the batch kernel; the indices
+    // of the others go to large, their solutions are left empty.
+    void solve(const std::vector<AssignmentProblem> &problems, std::vector<std::vector<double>> &solutions,
+               std::vector<size_t> &large);
+
+    double quantization_error() const { return m_packer.quantizer().max_error(); }
+    void report(std::ostream &out) const;
+
+private:
+    struct Unit {
+        cl::Kernel kernel;
+        std::vector<device_cost_t, aligned_allocator<device_cost_t>> matrices;
+        std::vector<cl_uint, aligned_allocator<cl_uint>> sizes, offsets;
+        std::vector<cl_int, aligned_allocator<cl_int>> stars;
+        cl::Buffer matrices_buffer, sizes_buffer, offsets_buffer, stars_buffer;
+        cl::Event write, run, read;
+        const Batch *batch = nullptr;
+    };
+
+    void collect(Unit &unit, const std::vector<AssignmentProblem> &problems,
+                 std::vector<std::vector<double>> &solutions);
+
+    cl::CommandQueue m_q;
+    std::vector<Unit> m_units;
+    BatchPacker m_packer;
+
+    size_t m_solved = 0, m_launches = 0;
+    double m_seconds = 0;
+    cl_ulong m_write_ns = 0, m_kernel_ns = 0, m_read_ns = 0;
+};
@@ -0,0 +1,61 @@
+#include "batch_plan.h"
+#include "cpu_backend.h"
+
+#include <algorithm>
+
+std::vector<Batch> plan_batches(const std::vector<AssignmentProblem> &problems, std::vector<size_t> &large) {
+    const size_t bin_sizes[] = {8, 16, BATCH_MAX_SIZE};
+    std::vector<Batch> bins(sizeof(bin_sizes) / sizeof(bin_sizes[0]));
+    for (size_t i = 0; i < problems.size(); i++) {
+        const size_t size = std::max(problems[i].rows, problems[i].columns);
+        size_t bin = 0;
+        while (bin < bins.size() && size > bin_sizes[bin]) {
+            bin++;
+        }
+        if (bin == bins.size()) {
+            large.push_back(i);
+        } else {
+            bins[bin].push_back(i);
+        }
+    }
+
+    std::vector<Batch> batches;
+    for (const Batch &bin : bins) {
+        for (size_t first = 0; first < bin.size(); first += BATCH_CAPACITY) {
+            const size_t last = std::min(bin.size(), first + BATCH_CAPACITY);
+            batches.push_back(Batch(bin.begin() + first, bin.begin() + last));
+        }
+    }
+    return batches;
+}
+
+BatchPacker::BatchPacker()
+    : m_host(std::unique_ptr<SolverBackend>(new CpuBackend())), m_stars(BATCH_MAX_SIZE) {
+}
+
+void BatchPacker::pack(const std::vector<AssignmentProblem> &problems, const Batch &batch,
+                       device_cost_t *matrices, uint32_t *sizes, uint32_t *offsets, int *stars) {
+    uint32_t offset = 0;
+    for (size_t p = 0; p < batch.size(); p++) {
+        const AssignmentProblem &problem = problems[batch[p]];
+        m_host.prepare(problem.costs.data(), problem.rows, problem.columns, m_stars.data());
+
+        MunkresState &state = m_host.backend().state();
+        m_quantizer.set_scale(state);
+        m_quantizer.quantize(state, matrices + offset, true);
+        sizes[p] = static_cast<uint32_t>(state.size);
+        offsets[p] = offset;
+        std::copy(m_stars.begin(), m_stars.begin() + state.size, stars + p * BATCH_MAX_SIZE);
+        offset += static_cast<uint32_t>(state.size * state.size);
+    }
+}
+
+void BatchPacker::unpack(const std::vector<AssignmentProblem> &problems, const Batch &batch, const int *stars,
+                         std::vector<std::vector<double>> &solutions) {
+    for (size_t p = 0; p < batch.size(); p++) {
+        const AssignmentProblem &problem = problems[batch[p]];
+        std::vector<double> &solution = solutions[batch[p]];
+        solution.resize(problem.costs.size());
+        MunkresContext::finish(stars + p * BATCH_MAX_SIZE, solution.data(), problem.rows, problem.columns);
+    }
+}
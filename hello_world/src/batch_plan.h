@@ -0,0 +1,47 @@
+#pragma once
+
+#include "cost_quantizer.h"
+#include "munkres_context.h"
+
+#include <cstdint>
+#include <vector>
+
+// Largest matrix munkres_batch_kernel solves and the most problems per
+// launch; both must match src/munkres_batch.cpp.
+constexpr size_t BATCH_MAX_SIZE = 32;
+constexpr size_t BATCH_CAPACITY = 256;
+
+// Indices of the problems solved by one launch.
+typedef std::vector<size_t> Batch;
+
+// Bins the problems that fit the batch kernel by padded size (up to 8,
+// 16 or 32) so that one launch holds problems of similar cost, and cuts
+// every bin into batches of at most BATCH_CAPACITY problems. The indices
+// of the larger problems go to large.
+std::vector<Batch> plan_batches(const std::vector<AssignmentProblem> &problems, std::vector<size_t> &large);
+
+// Host side of a launch: prepares the problems of a batch into the packed
+// layout munkres_batch_kernel takes, and turns the stars it returns into
+// solutions.
+class BatchPacker {
+public:
+    BatchPacker();
+
+    // Pads, reduces and stars every problem of batch, and writes their
+    // quantized matrices back to back to matrices, with the size table
+    // (sizes, offsets) and the stars of step 1.
+    void pack(const std::vector<AssignmentProblem> &problems, const Batch &batch,
+              device_cost_t *matrices, uint32_t *sizes, uint32_t *offsets, int *stars);
+
+    // solutions[i] for every problem i of batch, as MunkresContext::solve()
+    // leaves it.
+    static void unpack(const std::vector<AssignmentProblem> &problems, const Batch &batch, const int *stars,
+                       std::vector<std::vector<double>> &solutions);
+
+    const CostQuantizer &quantizer() const { return m_quantizer; }
+
+private:
+    MunkresContext m_host;
+    CostQuantizer m_quantizer;
+    std::vector<int> m_stars;
+};
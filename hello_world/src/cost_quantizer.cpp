@@ -0,0 +1,63 @@
+#include "cost_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+template <typename Cost>
+static Cost quantize_value(double value, double scale) {
+    return static_cast<Cost>(value * scale);
+}
+
+template <>
+inline int32_t quantize_value<int32_t>(double value, double scale) {
+    return static_cast<int32_t>(std::llround(value * scale));
+}
+
+template <typename Cost>
+static double dequantize_value(Cost value, double scale) {
+    return value / scale;
+}
+
+void CostQuantizer::set_scale(const MunkresState &state) {
+#if COST_TYPE == COST_FIXED
+    (void)state;
+    m_scale = std::ldexp(1.0, COST_FIXED_W - COST_FIXED_I);
+    m_limit = std::ldexp(1.0, COST_FIXED_I - 3);
+#elif COST_TYPE == COST_INT32
+    double largest = 0;
+    for (size_t row = 0; row < state.size; row++) {
+        for (size_t col = 0; col < state.size; col++) {
+            largest = std::max(largest, state.matrix[row][col]);
+        }
+    }
+    m_scale = largest > 0 ? std::ldexp(1.0, static_cast<int>(std::floor(std::log2(std::ldexp(1.0, 29) / largest)))) : 1;
+    m_limit = std::ldexp(1.0, 29) / m_scale;
+#else
+    (void)state;
+    m_scale = 1;
+    m_limit = std::numeric_limits<double>::max();
+#endif
+}
+
+void CostQuantizer::quantize(MunkresState &state, device_cost_t *device, bool track_error) {
+    for (size_t row = 0; row < state.size; row++) {
+        for (size_t col = 0; col < state.size; col++) {
+            double &value = state.matrix[row][col];
+            // The error is measured against the cost before clamping, so
+            // it bounds what clamping loses too.
+            const double original = value;
+            if (value > m_limit) {
+                value = m_limit;
+                m_clamped++;
+            }
+            const device_cost_t quantized = quantize_value<device_cost_t>(value, m_scale);
+            const double restored = dequantize_value(quantized, m_scale);
+            if (track_error && std::isfinite(original)) {
+                m_max_error = std::max(m_max_error, std::fabs(original - restored));
+            }
+            device[row * state.size + col] = quantized;
+            value = restored;
+        }
+    }
+}
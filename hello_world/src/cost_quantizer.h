@@ -0,0 +1,34 @@
+#pragma once
+
+#include "cost_type.h"
+#include "solver_backend.h"
+
+// Converts the host's double matrix to the device cost type (see
+// cost_type.h) and keeps track of the precision lost.
+class CostQuantizer {
+public:
+    // Picks the scale for a freshly reduced matrix: costs are finite and
+    // non negative. Fixed point has a fixed scale; int32 takes the largest
+    // power of two keeping the costs below 2^29. Both keep two bits of
+    // headroom for step 5 growing the covered rows; costs above the limit
+    // are clamped, and the clamping counts towards max_error().
+    void set_scale(const MunkresState &state);
+
+    // Writes state's matrix to device (dense, rows size apart) and the
+    // quantized values back to state, so host and device work on the
+    // same costs. track_error counts the difference towards max_error():
+    // set it for the reduced input, not for values the solver derived
+    // from already quantized ones.
+    void quantize(MunkresState &state, device_cost_t *device, bool track_error);
+
+    // device_cost_t units per cost unit (raw bits, for ap_fixed).
+    double scale() const { return m_scale; }
+    double max_error() const { return m_max_error; }
+    size_t clamped() const { return m_clamped; }
+
+private:
+    double m_scale = 1;
+    double m_limit = 0;
+    double m_max_error = 0;
+    size_t m_clamped = 0;
+};
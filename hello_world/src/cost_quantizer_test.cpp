@@ -0,0 +1,110 @@
+// Test of CostQuantizer for the COST_TYPE it is built with: every cost it
+// writes back, clamped or only rounded, must be within max_error() of the
+// cost it was given, so the host's --verify bound (2 n max_error() off the
+// optimum) holds. The sample 10x10 input has costs above the ap_fixed
+// limit, and a cost raised after set_scale() goes above the int32 one.
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "cost_quantizer.h"
+#include "cost_type.h"
+#include "cpu_backend.h"
+#include "munkres_context.h"
+
+// The CPU backend working on quantized costs, as a device does.
+class QuantizedCpuBackend : public CpuBackend {
+public:
+    const char *name() const override { return "quantized"; }
+
+    void reduce(bool rows_first) override {
+        CpuBackend::reduce(rows_first);
+        m_quantizer.set_scale(state());
+        m_quantized.resize(state().size * state().size);
+        m_quantizer.quantize(state(), m_quantized.data(), true);
+    }
+
+    double quantization_error() const override { return m_quantizer.max_error(); }
+
+private:
+    CostQuantizer m_quantizer;
+    std::vector<device_cost_t> m_quantized;
+};
+
+static double assignment_cost(const std::vector<double> &costs, const std::vector<double> &solution) {
+    double total = 0;
+    for (size_t i = 0; i < costs.size(); i++) {
+        if (solution[i] == 0) {
+            total += costs[i];
+        }
+    }
+    return total;
+}
+
+int main() {
+    std::ifstream input("src/10x10_assignment.txt");
+    size_t size = 0, columns = 0;
+    input >> size >> columns;
+    std::vector<double> costs(size * columns);
+    for (double &cost : costs) {
+        input >> cost;
+    }
+    if (!input || size != columns || size == 0) {
+        std::cerr << "Can't read src/10x10_assignment.txt" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+
+    // Quantizing a reduced matrix with one cost far above any limit
+    CpuBackend reduced;
+    reduced.resize(size);
+    MunkresState &state = reduced.state();
+    std::copy(costs.begin(), costs.end(), state.matrix.data);
+    reduced.reduce(true);
+    CostQuantizer quantizer;
+    quantizer.set_scale(state);
+    state.matrix[0][size - 1] = 1000 * (state.matrix[0][size - 1] + 1);
+    const std::vector<double> original(state.matrix.data, state.matrix.data + size * size);
+    std::vector<device_cost_t> device(size * size);
+    quantizer.quantize(state, device.data(), true);
+    for (size_t i = 0; i < size * size; i++) {
+        if (std::fabs(original[i] - state.matrix.data[i]) > quantizer.max_error()) {
+            std::cerr << "Cell " << i << ": " << original[i] << " became " << state.matrix.data[i]
+                      << ", beyond the largest error " << quantizer.max_error() << std::endl;
+            failures++;
+        }
+    }
+#if COST_TYPE == COST_FIXED || COST_TYPE == COST_INT32
+    if (quantizer.clamped() == 0) {
+        std::cerr << "No cost was clamped" << std::endl;
+        failures++;
+    }
+#endif
+    std::cout << quantizer.clamped() << " costs clamped, largest error " << quantizer.max_error() << std::endl;
+
+    // Solving the sample on quantized costs stays within the bound the
+    // host verifies against.
+    MunkresContext reference(std::unique_ptr<SolverBackend>(new CpuBackend()));
+    MunkresContext quantized(std::unique_ptr<SolverBackend>(new QuantizedCpuBackend()));
+    std::vector<double> expected = costs;
+    reference.solve(expected.data(), size, size);
+    std::vector<double> result = costs;
+    quantized.solve(result.data(), size, size);
+    const double optimum = assignment_cost(costs, expected);
+    const double cost = assignment_cost(costs, result);
+    const double tolerance = 2 * size * quantized.backend().quantization_error();
+    std::cout << "Cost " << cost << ", reference " << optimum << ", bound " << tolerance << std::endl;
+    if (std::fabs(cost - optimum) > tolerance) {
+        std::cerr << "Cost off the optimum by more than the bound" << std::endl;
+        failures++;
+    }
+
+    std::cout << "Cost type: " << COST_NAME << std::endl;
+    std::cout << "TEST " << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Type of the matrix elements on the device, chosen at build time with
+// -DCOST_TYPE=<one of the below> (make COST_TYPE=double|float|fixed|int32).
+// Narrower types double the elements per AXI beat and make the
+// comparators and adders cheaper; the host quantizes the reduced matrix
+// to the type and reports the precision lost.
+#define COST_DOUBLE 0
+#define COST_FLOAT  1
+#define COST_FIXED  2
+#define COST_INT32  3
+
+#ifndef COST_TYPE
+#define COST_TYPE COST_DOUBLE
+#endif
+
+#ifndef COST_FIXED_W
+#define COST_FIXED_W 32
+#endif
+#ifndef COST_FIXED_I
+#define COST_FIXED_I 20
+#endif
+
+#include <stdint.h>
+
+// device_cost_t is the layout in device memory, the type the host
+// allocates; cost_t is the type the kernels compute with. They differ
+// only for ap_fixed, stored as its raw bits: value * 2^(W - I).
+#if COST_TYPE == COST_DOUBLE
+typedef double device_cost_t;
+#define COST_NAME "double"
+#elif COST_TYPE == COST_FLOAT
+typedef float device_cost_t;
+#define COST_NAME "float"
+#elif COST_TYPE == COST_FIXED
+static_assert(COST_FIXED_W <= 32 && COST_FIXED_I < COST_FIXED_W, "ap_fixed costs must fit in 32 bits");
+typedef int32_t device_cost_t;
+#define COST_NAME "ap_fixed"
+#elif COST_TYPE == COST_INT32
+typedef int32_t device_cost_t;
+#define COST_NAME "int32"
+#else
+#error "Unknown COST_TYPE"
+#endif
+
+#if COST_TYPE == COST_FIXED
+#include "ap_fixed.h"
+typedef ap_fixed<COST_FIXED_W, COST_FIXED_I> cost_t;
+#else
+typedef device_cost_t cost_t;
+#endif
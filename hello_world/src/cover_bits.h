@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Row and column covers as find_uncovered_kernel and step5_kernel read
+// them: bit i % COVER_WORD_BITS of word i / COVER_WORD_BITS is set when
+// line i is covered. The host keeps one flag per line; only the packed
+// words cross the bus, a 32nd of the flags.
+#define COVER_WORD_BITS 32
+
+inline size_t cover_words(size_t size) {
+    return (size + COVER_WORD_BITS - 1) / COVER_WORD_BITS;
+}
+
+// Packs the size flags of mask into cover_words(size) words; the bits
+// past size are clear.
+template <typename Flag, typename Word>
+void pack_covers(const Flag *mask, size_t size, Word *words) {
+    for (size_t w = 0; w < cover_words(size); w++) {
+        uint32_t word = 0;
+        for (size_t b = 0; b < COVER_WORD_BITS && w * COVER_WORD_BITS + b < size; b++) {
+            if (mask[w * COVER_WORD_BITS + b]) {
+                word |= uint32_t(1) << b;
+            }
+        }
+        words[w] = word;
+    }
+}
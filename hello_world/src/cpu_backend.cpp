@@ -0,0 +1,139 @@
+#include "cpu_backend.h"
+
+#include <algorithm>
+#include <limits>
+
+static void replace_infinites(MunkresState &state) {
+    const size_t size = state.size;
+    double max = state.matrix[0][0];
+    constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+    // Find the greatest value in the matrix that isn't infinity
+    for (size_t row = 0; row < size; row++) {
+        for (size_t col = 0; col < size; col++) {
+            if (state.matrix[row][col] != infinity) {
+                if (max == infinity) {
+                    max = state.matrix[row][col];
+                } else {
+                    max = std::max<double>(max, state.matrix[row][col]);
+                }
+            }
+        }
+    }
+
+    // A value higher than the maximum value present in the matrix
+    if (max == infinity) {
+        max = 0;
+    } else {
+        max++;
+    }
+
+    for (size_t row = 0; row < size; row++) {
+        for (size_t col = 0; col < size; col++) {
+            if (state.matrix[row][col] == infinity) {
+                state.matrix[row][col] = max;
+            }
+        }
+    }
+}
+
+static void minimize_along_direction(MunkresState &state, bool over_columns) {
+    const size_t size = state.size;
+    for (size_t i = 0; i < size; i++) {
+        double min = over_columns ? state.matrix[0][i] : state.matrix[i][0];
+
+        for (size_t j = 1; j < size && min > 0; j++) {
+            min = std::min<double>(min, over_columns ? state.matrix[j][i] : state.matrix[i][j]);
+        }
+
+        if (min > 0) {
+            for (size_t j = 0; j < size; j++) {
+                if (over_columns) {
+                    state.matrix[j][i] -= min;
+                } else {
+                    state.matrix[i][j] -= min;
+                }
+            }
+        }
+    }
+}
+
+void cpu_reduce(MunkresState &state, bool rows_first) {
+    std::fill(state.row_mask, state.row_mask + state.size, 0);
+    std::fill(state.col_mask, state.col_mask + state.size, 0);
+
+    replace_infinites(state);
+    minimize_along_direction(state, !rows_first);
+    minimize_along_direction(state, rows_first);
+}
+
+bool cpu_find_uncovered_zero(const MunkresState &state, size_t &row, size_t &col) {
+    for (row = 0; row < state.size; row++) {
+        if (!state.row_mask[row]) {
+            for (col = 0; col < state.size; col++) {
+                if (!state.col_mask[col] && state.matrix[row][col] == 0) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void cpu_step5(MunkresState &state) {
+    const size_t size = state.size;
+    double h = std::numeric_limits<double>::max();
+
+    // Find minimum uncovered value; uncovered zeros don't exist here,
+    // step 3 would have primed them.
+    for (size_t row = 0; row < size; row++) {
+        if (!state.row_mask[row]) {
+            for (size_t col = 0; col < size; col++) {
+                if (!state.col_mask[col]) {
+                    h = std::min(h, state.matrix[row][col]);
+                }
+            }
+        }
+    }
+
+    // Add h to covered rows
+    for (size_t row = 0; row < size; row++) {
+        if (state.row_mask[row]) {
+            for (size_t col = 0; col < size; col++) {
+                state.matrix[row][col] += h;
+            }
+        }
+    }
+
+    // Subtract h from uncovered columns
+    for (size_t row = 0; row < size; row++) {
+        for (size_t col = 0; col < size; col++) {
+            if (!state.col_mask[col]) {
+                state.matrix[row][col] -= h;
+            }
+        }
+    }
+}
+
+void CpuBackend::resize(size_t size) {
+    m_matrix.resize(size * size);
+    m_row_mask.resize(size);
+    m_col_mask.resize(size);
+    m_state.matrix.data = m_matrix.data();
+    m_state.matrix.size = size;
+    m_state.row_mask = m_row_mask.data();
+    m_state.col_mask = m_col_mask.data();
+    m_state.size = size;
+}
+
+void CpuBackend::reduce(bool rows_first) {
+    cpu_reduce(m_state, rows_first);
+}
+
+bool CpuBackend::find_uncovered_zero(size_t &row, size_t &col) {
+    return cpu_find_uncovered_zero(m_state, row, col);
+}
+
+void CpuBackend::step5() {
+    cpu_step5(m_state);
+}
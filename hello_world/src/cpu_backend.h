@@ -0,0 +1,28 @@
+#pragma once
+
+#include "solver_backend.h"
+
+#include <vector>
+
+// Reference implementations of the offloaded steps, shared by the
+// backends that only move part of the work to a device.
+void cpu_reduce(MunkresState &state, bool rows_first);
+bool cpu_find_uncovered_zero(const MunkresState &state, size_t &row, size_t &col);
+void cpu_step5(MunkresState &state);
+
+// Runs everything on the host; needs no device, runtime or xclbin.
+class CpuBackend : public SolverBackend {
+public:
+    const char *name() const override { return "cpu"; }
+    MunkresState &state() override { return m_state; }
+    void resize(size_t size) override;
+    void reduce(bool rows_first) override;
+    bool find_uncovered_zero(size_t &row, size_t &col) override;
+    void step5() override;
+
+private:
+    std::vector<double> m_matrix;
+    std::vector<char> m_row_mask;
+    std::vector<char> m_col_mask;
+    MunkresState m_state;
+};
@@ -1,16 +1,37 @@
 #include "hls_stream.h"
 #include "ap_int.h"
 #include <stdbool.h>
+#include "cost_type.h"
+#include "cover_bits.h"
 
-#define MAX_SIZE 256
+// Columns held on chip at a time; wider matrices are searched tile by
+// tile. A multiple of LANES.
+#define TILE_COLS 256
+// Columns compared per cycle.
+#define LANES 8
+// Rows burst into local memory at a time; divides COVER_WORD_BITS, so
+// the covers of a block's rows are in one word.
+#define BLOCK_ROWS 4
+// Size the loop bounds are estimated for (LOOP_TRIPCOUNT only).
+#define TYPICAL_SIZE 1024
 
 extern "C" {
 
+// First uncovered element equal to item, in row major order, in the
+// dense size x size matrix (rows size apart); any size. The covers come
+// packed, one bit per line (see cover_bits.h), and are unpacked on chip.
+//
+// Rows are burst BLOCK_ROWS at a time, one column tile at a time, into
+// local memory partitioned LANES ways, so each cycle compares LANES
+// columns against item under the column mask; a priority encoder keeps
+// the lowest matching column. Blocks whose rows are all covered are never
+// read, and once a row of the block matches, the rows after it are
+// skipped. The column mask tile is only reloaded when the tile changes,
+// never for matrices of up to TILE_COLS columns.
 void find_uncovered_kernel(
-    const double matrix[MAX_SIZE][MAX_SIZE],
-    const int mask_matrix[MAX_SIZE][MAX_SIZE],
-    const bool row_mask[MAX_SIZE],
-    const bool col_mask[MAX_SIZE],
+    const cost_t *matrix,
+    const ap_uint<32> *row_cover,
+    const ap_uint<32> *col_cover,
     const double item,
     ap_uint<32> size,
     ap_uint<32>* row_out,
@@ -18,9 +39,8 @@ void find_uncovered_kernel(
     bool* found
 ) {
 #pragma HLS INTERFACE m_axi port = matrix offset = slave bundle = gmem
-#pragma HLS INTERFACE m_axi port = mask_matrix offset = slave bundle = gmem
-#pragma HLS INTERFACE m_axi port = row_mask offset = slave bundle = gmem
-#pragma HLS INTERFACE m_axi port = col_mask offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = row_cover offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = col_cover offset = slave bundle = gmem
 #pragma HLS INTERFACE s_axilite port = item bundle = control
 #pragma HLS INTERFACE s_axilite port = size bundle = control
 #pragma HLS INTERFACE m_axi port = row_out offset = slave bundle = gmem
@@ -28,22 +48,106 @@ void find_uncovered_kernel(
 #pragma HLS INTERFACE m_axi port = found offset = slave bundle = gmem
 #pragma HLS INTERFACE s_axilite port = return bundle = control
 
+    bool local_col_mask[TILE_COLS];
+#pragma HLS ARRAY_PARTITION variable = local_col_mask cyclic factor = LANES
+    cost_t block[BLOCK_ROWS][TILE_COLS];
+#pragma HLS ARRAY_PARTITION variable = block cyclic factor = LANES dim = 2
+
+    const cost_t target = item;
+    bool mask_loaded = false;
+    ap_uint<32> mask_tile = 0;
     *found = false;
-    
-    row_loop: for (ap_uint<32> row = 0; row < size; row++) {
-        if (!row_mask[row]) {
-            col_loop: for (ap_uint<32> col = 0; col < size; col++) {
-                if (!col_mask[col]) {
-                    if (matrix[row][col] == item) {
-                        *row_out = row;
-                        *col_out = col;
-                        *found = true;
-                        return;
+
+    block_loop: for (ap_uint<32> first = 0; first < size; first += BLOCK_ROWS) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE / BLOCK_ROWS
+        bool open[BLOCK_ROWS];
+#pragma HLS ARRAY_PARTITION variable = open complete
+        bool uncovered = false;
+        const ap_uint<32> row_word = row_cover[first / COVER_WORD_BITS];
+        check_rows: for (int r = 0; r < BLOCK_ROWS; r++) {
+#pragma HLS UNROLL
+            open[r] = first + r < size && !row_word[(first + r) % COVER_WORD_BITS];
+            uncovered = uncovered || open[r];
+        }
+        if (!uncovered) {
+            continue;
+        }
+
+        // Lowest row of the block with a match so far, and its column.
+        int best = BLOCK_ROWS;
+        ap_uint<32> best_col = 0;
+
+        tile_loop: for (ap_uint<32> tile = 0; tile < size; tile += TILE_COLS) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE / TILE_COLS
+            const ap_uint<32> width = (size - tile < TILE_COLS) ? ap_uint<32>(size - tile) : ap_uint<32>(TILE_COLS);
+            if (!mask_loaded || mask_tile != tile) {
+                // Tiles start on a word: TILE_COLS is a multiple of
+                // COVER_WORD_BITS.
+                ap_uint<32> col_word = 0;
+                unpack_col_mask: for (ap_uint<32> i = 0; i < width; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+                    if (i % COVER_WORD_BITS == 0) {
+                        col_word = col_cover[(tile + i) / COVER_WORD_BITS];
+                    }
+                    local_col_mask[i] = col_word[i % COVER_WORD_BITS];
+                }
+                mask_tile = tile;
+                mask_loaded = true;
+            }
+
+            burst_rows: for (int r = 0; r < BLOCK_ROWS; r++) {
+                if (open[r] && r < best) {
+                    burst_cols: for (ap_uint<32> col = 0; col < width; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+                        block[r][col] = matrix[(first + r) * size + tile + col];
+                    }
+                }
+            }
+
+            search_rows: for (int r = 0; r < BLOCK_ROWS; r++) {
+                if (!open[r] || r >= best) {
+                    continue;
+                }
+                search_chunks: for (ap_uint<32> base = 0; base < width; base += LANES) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS / LANES
+                    bool match[LANES];
+#pragma HLS ARRAY_PARTITION variable = match complete
+                    compare_lanes: for (int lane = 0; lane < LANES; lane++) {
+#pragma HLS UNROLL
+                        const ap_uint<32> col = base + lane;
+                        match[lane] = col < width && !local_col_mask[col] && block[r][col] == target;
+                    }
+
+                    // Priority encoder: the lowest matching lane wins, which
+                    // keeps the first match in row major order.
+                    bool hit = false;
+                    int first_lane = 0;
+                    encode: for (int lane = LANES - 1; lane >= 0; lane--) {
+#pragma HLS UNROLL
+                        if (match[lane]) {
+                            hit = true;
+                            first_lane = lane;
+                        }
+                    }
+                    if (hit) {
+                        best = r;
+                        best_col = tile + base + first_lane;
+                        break;
                     }
                 }
             }
         }
+
+        if (best < BLOCK_ROWS) {
+            *row_out = first + best;
+            *col_out = best_col;
+            *found = true;
+            return;
+        }
     }
 }
 
-} 
+}
@@ -0,0 +1,89 @@
+// C simulation testbench: compares find_uncovered_kernel with a serial
+// software model of the search on random matrices and masks, including
+// sizes spanning several column tiles.
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ap_int.h"
+#include "cost_type.h"
+#include "cover_bits.h"
+
+// Largest size tried; the kernel's column tiles are 256 wide.
+const int MAX_SIZE = 700;
+
+extern "C" {
+void find_uncovered_kernel(const cost_t *matrix, const ap_uint<32> *row_cover, const ap_uint<32> *col_cover,
+                           const double item, ap_uint<32> size, ap_uint<32> *row_out, ap_uint<32> *col_out,
+                           bool *found);
+}
+
+// First uncovered element equal to item, in row major order.
+static bool find_uncovered_model(const cost_t *matrix, const bool *row_mask, const bool *col_mask, cost_t item,
+                                 int size, int &row, int &col) {
+    for (row = 0; row < size; row++) {
+        if (!row_mask[row]) {
+            for (col = 0; col < size; col++) {
+                if (!col_mask[col] && matrix[row * size + col] == item) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int main() {
+    std::vector<cost_t> matrix(MAX_SIZE * MAX_SIZE);
+    static bool row_mask[MAX_SIZE], col_mask[MAX_SIZE];
+    std::vector<ap_uint<32>> row_cover(cover_words(MAX_SIZE)), col_cover(cover_words(MAX_SIZE));
+
+    // Sizes around the lane, block and tile widths, then random ones.
+    const int edge_sizes[] = {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 255, 256, 257, 511, 512, 513, 700};
+    const int trials = 1000;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> random_size(1, MAX_SIZE);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    int mismatches = 0, hits = 0;
+    for (int trial = 0; trial < trials; trial++) {
+        const int n_edge = sizeof(edge_sizes) / sizeof(edge_sizes[0]);
+        const int size = trial < n_edge ? edge_sizes[trial] : random_size(generator);
+        // Sparse to dense matches, lightly to heavily covered
+        const double match_rate = unit(generator) * unit(generator) * 0.2;
+        const double cover_rate = unit(generator);
+        const double item = (trial % 4 == 0) ? 3 : 0;
+
+        for (int i = 0; i < size * size; i++) {
+            matrix[i] = unit(generator) < match_rate ? item : 5 + int(1000 * unit(generator));
+        }
+        for (int i = 0; i < MAX_SIZE; i++) {
+            row_mask[i] = unit(generator) < cover_rate;
+            col_mask[i] = unit(generator) < cover_rate;
+        }
+
+        int expected_row = 0, expected_col = 0;
+        const bool expected = find_uncovered_model(matrix.data(), row_mask, col_mask, item, size, expected_row, expected_col);
+
+        ap_uint<32> row_out = 0, col_out = 0;
+        bool found = true;
+        pack_covers(row_mask, size, row_cover.data());
+        pack_covers(col_mask, size, col_cover.data());
+        find_uncovered_kernel(matrix.data(), row_cover.data(), col_cover.data(), item, size, &row_out, &col_out,
+                              &found);
+
+        if (found != expected || (found && (int(row_out) != expected_row || int(col_out) != expected_col))) {
+            std::cerr << "Trial " << trial << ", size " << size << ": kernel " << found << " (" << row_out << ", "
+                      << col_out << "), model " << expected << " (" << expected_row << ", " << expected_col << ")"
+                      << std::endl;
+            mismatches++;
+        }
+        hits += expected;
+    }
+
+    std::cout << trials << " searches, " << hits << " with a match, " << mismatches << " mismatches" << std::endl;
+    std::cout << "TEST " << (mismatches == 0 ? "PASSED" : "FAILED") << std::endl;
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+#include "hybrid_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+double LatencyModel::predict(size_t n) const {
+    const double elements = static_cast<double>(n) * n;
+    return overhead + per_element * elements + per_step * elements * n;
+}
+
+// Solves the 3x3 system a x = b by Gaussian elimination with partial
+// pivoting.
+static void solve3(double a[3][3], double b[3], double x[3]) {
+    for (int col = 0; col < 3; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < 3; row++) {
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (int row = col + 1; row < 3; row++) {
+            const double factor = a[col][col] != 0 ? a[row][col] / a[col][col] : 0;
+            for (int k = col; k < 3; k++) {
+                a[row][k] -= factor * a[col][k];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = 2; row >= 0; row--) {
+        double sum = b[row];
+        for (int k = row + 1; k < 3; k++) {
+            sum -= a[row][k] * x[k];
+        }
+        x[row] = a[row][row] != 0 ? sum / a[row][row] : 0;
+    }
+}
+
+LatencyModel calibrate(MunkresContext &context, const std::vector<size_t> &sizes, int repeats) {
+    std::mt19937 generator(40);
+    std::uniform_int_distribution<int> value(0, 999);
+
+    // Normal equations of the fit, every row scaled by 1 / t so the error
+    // is relative.
+    double ata[3][3] = {}, atb[3] = {};
+    for (size_t n : sizes) {
+        std::vector<double> times;
+        for (int r = 0; r < std::max(repeats, 1); r++) {
+            std::vector<double> matrix(n * n);
+            for (double &cost : matrix) {
+                cost = value(generator);
+            }
+            auto start = std::chrono::steady_clock::now();
+            context.solve(matrix.data(), n, n);
+            times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        const double t = std::max(times[times.size() / 2], 1e-9);
+
+        const double elements = static_cast<double>(n) * n;
+        const double row[3] = {1 / t, elements / t, elements * n / t};
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                ata[i][j] += row[i] * row[j];
+            }
+            atb[i] += row[i];
+        }
+    }
+
+    double x[3] = {};
+    solve3(ata, atb, x);
+    // Noise can push a term below zero; no term is really negative.
+    LatencyModel model;
+    model.overhead = std::max(x[0], 0.0);
+    model.per_element = std::max(x[1], 0.0);
+    model.per_step = std::max(x[2], 0.0);
+    return model;
+}
+
+void log_calibration(std::ostream &out, const LatencyModel &host, const DeviceLatencyModel &device,
+                     size_t element_bytes, size_t limit) {
+    const LatencyModel *models[] = {&host, &device.on_chip, &device.off_chip};
+    const char *names[] = {"host", "device on chip", "device off chip"};
+    for (int i = 0; i < 3; i++) {
+        if (i == 1 && !device.on_chip_max) {
+            continue;
+        }
+        out << "Calibration " << names[i] << ": overhead " << models[i]->overhead * 1e6 << " us, "
+            << models[i]->per_element * 1e9 << " ns per element, " << models[i]->per_step * 1e9
+            << " ns per n^3" << std::endl;
+    }
+    const LatencyModel &transfers = device.on_chip_max ? device.on_chip : device.off_chip;
+    if (transfers.per_element > 0) {
+        out << "Calibration device: effective bandwidth " << element_bytes / transfers.per_element / 1e6 << " MB/s"
+            << std::endl;
+    }
+
+    // The predictions cross more than once when the paths differ, so list
+    // every run of sizes one backend wins.
+    out << "Routing:";
+    size_t from = 1;
+    for (size_t n = 1; n <= limit; n++) {
+        const bool on_device = device.predict(n) < host.predict(n);
+        if (n == limit || (device.predict(n + 1) < host.predict(n + 1)) != on_device) {
+            out << (from > 1 ? "," : "") << " n " << from << "-" << n << " to the " << (on_device ? "device" : "host");
+            from = n + 1;
+        }
+    }
+    out << "; larger sizes to the one predicted faster" << std::endl;
+}
+
+HybridBackend::HybridBackend(std::unique_ptr<SolverBackend> host, std::unique_ptr<SolverBackend> device,
+                             const LatencyModel &host_model, const DeviceLatencyModel &device_model)
+    : m_host(std::move(host)), m_device(std::move(device)), m_active(m_host.get()), m_host_model(host_model),
+      m_device_model(device_model) {
+}
+
+void HybridBackend::resize(size_t size) {
+    if (m_device_model.predict(size) < m_host_model.predict(size)) {
+        m_active = m_device.get();
+        m_device_solves++;
+    } else {
+        m_active = m_host.get();
+        m_host_solves++;
+    }
+    m_active->resize(size);
+    // The solver works through these pointers in the chosen backend's
+    // buffers.
+    m_state = m_active->state();
+}
+
+double HybridBackend::quantization_error() const {
+    return std::max(m_host->quantization_error(), m_device->quantization_error());
+}
+
+void HybridBackend::report(std::ostream &out) const {
+    out << "Hybrid: " << m_host_solves << " solves on " << m_host->name() << ", " << m_device_solves << " on "
+        << m_device->name() << std::endl;
+    m_host->report(out);
+    m_device->report(out);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "munkres_context.h"
+#include "solver_backend.h"
+
+#include <memory>
+#include <vector>
+
+// Predicted time of one solve on a backend, in seconds, for an n x n
+// problem: overhead + per_element * n^2 + per_step * n^3.
+struct LatencyModel {
+    double overhead = 0;     // per solve: launches, queue and setup
+    double per_element = 0;  // per matrix element: transfers, reduction
+    double per_step = 0;     // per n^3: the search and update steps
+
+    double predict(size_t n) const;
+};
+
+// Device latency with one LatencyModel per data path: on_chip for sizes
+// up to on_chip_max, whose iterations run whole on the device, off_chip
+// for larger ones, which take a launch per search. on_chip_max 0 when
+// every size takes the off_chip path.
+struct DeviceLatencyModel {
+    LatencyModel on_chip;
+    LatencyModel off_chip;
+    size_t on_chip_max = 0;
+
+    double predict(size_t n) const { return n <= on_chip_max ? on_chip.predict(n) : off_chip.predict(n); }
+};
+
+// Times repeats solves of random matrices of each size on context and
+// fits a LatencyModel to the median times (least squares relative to the
+// time, so the small sizes weigh as much as the large ones).
+LatencyModel calibrate(MunkresContext &context, const std::vector<size_t> &sizes, int repeats);
+
+// Logs the models, the device's effective bandwidth for elements of
+// element_bytes, and the ranges of n up to limit that each backend wins.
+void log_calibration(std::ostream &out, const LatencyModel &host, const DeviceLatencyModel &device,
+                     size_t element_bytes, size_t limit = 4096);
+
+// Routes every solve to the backend with the lower predicted latency for
+// its size; the device may win only some ranges, e.g. not above the sizes
+// it holds on chip. The choice is made in resize(), before the input is
+// written, and the solver then works in the chosen backend's state.
+class HybridBackend : public SolverBackend {
+public:
+    HybridBackend(std::unique_ptr<SolverBackend> host, std::unique_ptr<SolverBackend> device,
+                  const LatencyModel &host_model, const DeviceLatencyModel &device_model);
+
+    const char *name() const override { return "hybrid"; }
+    MunkresState &state() override { return m_state; }
+    void resize(size_t size) override;
+    void reduce(bool rows_first) override { m_active->reduce(rows_first); }
+    bool reduce_and_star(bool rows_first, int *stars) override { return m_active->reduce_and_star(rows_first, stars); }
+    bool find_uncovered_zero(size_t &row, size_t &col) override { return m_active->find_uncovered_zero(row, col); }
+    void step5() override { m_active->step5(); }
+    bool solve_from_stars(int *stars) override { return m_active->solve_from_stars(stars); }
+    double quantization_error() const override;
+    void report(std::ostream &out) const override;
+
+private:
+    std::unique_ptr<SolverBackend> m_host;
+    std::unique_ptr<SolverBackend> m_device;
+    SolverBackend *m_active;
+    LatencyModel m_host_model;
+    DeviceLatencyModel m_device_model;
+    size_t m_host_solves = 0, m_device_solves = 0;
+    MunkresState m_state;
+};
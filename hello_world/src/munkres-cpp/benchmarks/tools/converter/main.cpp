@@ -0,0 +1,66 @@
+#include <cstdlib>
+#include "matrixfile.h"
+#include "matrixtext.h"
+#include "matrixutils.h"
+#include <string>
+#include <vector>
+
+
+
+// Converts cost matrices from text to a MatrixFile (see matrixfile.h):
+//   matrixconverter.bin <input> <output> [float]
+// The input is in one of the formats parse () in matrixutils.h reads, or
+// in the format the FPGA host reads (rows and columns, then the costs),
+// matrices back to back in all of them.
+int main (int argc, char * argv [])
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv [0] << " <input> <output> [float]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        const bool single = argc > 3 && std::string ("float") == argv [3];
+        MatrixFileWriter writer (argv [2], single ? MatrixFile::FLOAT : MatrixFile::DOUBLE);
+        size_t count = 0;
+
+        const std::string text = MatrixText::read_file (argv [1]);
+        const size_t first = text.find_first_not_of (" \t\r\n");
+        if (std::string::npos != first && 0 == text.compare (first, 6, "Matrix") ) {
+            std::vector <Matrix <double> *> matrices;
+            const bool parsed = parse (text, matrices);
+            for (size_t i = 0; i < matrices.size (); ++i) {
+                writer.add (* matrices [i]);
+                delete matrices [i];
+            }
+            count = matrices.size ();
+            if (!parsed) {
+                std::cerr << "Bad matrix " << count << " in " << argv [1] << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            const std::vector <double> numbers = MatrixText::parse (text.data (), text.data () + text.size () );
+            size_t next = 0;
+            while (next < numbers.size () ) {
+                if (next + 1 >= numbers.size () || !(numbers [next] >= 1 && numbers [next + 1] >= 1) ||
+                        numbers [next] * numbers [next + 1] > static_cast <double> (numbers.size () - next - 2) ) {
+                    std::cerr << "Bad dimensions or too few values for matrix " << count << std::endl;
+                    return EXIT_FAILURE;
+                }
+                const size_t rows    = static_cast <size_t> (numbers [next]);
+                const size_t columns = static_cast <size_t> (numbers [next + 1]);
+                next += 2;
+                writer.add (rows, columns, numbers.data () + next);
+                next += rows * columns;
+                ++count;
+            }
+        }
+        writer.close ();
+        std::cout << count << " matrices written to " << argv [2] << std::endl;
+    }
+    catch (const std::exception & e) {
+        std::cerr << e.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
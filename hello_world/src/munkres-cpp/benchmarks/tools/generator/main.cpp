@@ -15,6 +15,7 @@ int main (int argc, char * argv [])
         matrices.push_back (matrix);
     }
     write <double> (matrices);
+    write_binary <double> (matrices);
 
     return EXIT_SUCCESS;
 }
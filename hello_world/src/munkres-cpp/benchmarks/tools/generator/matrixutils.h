@@ -2,6 +2,8 @@
 #define _MATRIX_UTILS_H_
 
 #include "matrix.h"
+#include "matrixfile.h"
+#include "matrixtext.h"
 #include <fstream>
 #include <random>
 #include <limits>
@@ -11,6 +13,7 @@
 
 
 const std::string fileName = "matrices.txt";
+const std::string binaryFileName = "matrices.bin";
 
 
 
@@ -63,6 +66,56 @@ std::istream & operator >> (std::istream & is, Matrix <T> & m)
 
 
 
+// Parses the matrices of text, each either as operator >> reads it or as
+// Matrix's own operator << lists it (a "Matrix:" line, then a line of
+// comma terminated costs per row). The costs are parsed in place, those
+// of a large matrix in parallel chunks.
+template <typename T>
+bool parse (const std::string & text, std::vector <Matrix <T> *> & matrices)
+{
+    const std::string marker ("Matrix");
+    size_t start = text.find (marker);
+    while (std::string::npos != start) {
+        const size_t next = text.find (marker, start + marker.size () );
+        const size_t end  = std::string::npos == next ? text.size () : next;
+        const size_t body = std::min (text.find ('\n', start), end);
+
+        size_t rows = 0;
+        size_t columns = 0;
+        if (0 == text.compare (start, marker.size () + 1, marker + ":") ) {
+            const size_t row_end = std::min (text.find ('\n', body + 1), end);
+            columns = MatrixText::parse (text.data () + body, text.data () + row_end, 1).size ();
+        } else {
+            const std::string header = text.substr (start, body - start);
+            const std::string size = header.substr (header.find_last_of (' ') + 1);
+            const size_t delimiter = size.find ("x");
+            if (std::string::npos == delimiter) {
+                return false;
+            }
+            rows    = std::stoul (size.substr (0, delimiter) );
+            columns = std::stoul (size.substr (delimiter + 1) );
+        }
+
+        const std::vector <double> costs = MatrixText::parse (text.data () + body, text.data () + end);
+        if (0 == columns || 0 != costs.size () % columns || (rows && costs.size () != rows * columns) ) {
+            return false;
+        }
+        rows = costs.size () / columns;
+        Matrix <T> * matrix = new Matrix <T> (rows, columns);
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t col = 0; col < columns; ++col) {
+                (* matrix) (row, col) = static_cast <T> (costs [row * columns + col]);
+            }
+        }
+        matrices.push_back (matrix);
+        start = next;
+    }
+
+    return true;
+}
+
+
+
 template <typename T>
 bool write (const std::vector <Matrix <T> *> & matrices)
 {
@@ -80,24 +133,42 @@ bool write (const std::vector <Matrix <T> *> & matrices)
 
 
 template <typename T>
-bool read (std::vector <Matrix <T> *> & matrices)
+bool write_binary (const std::vector <Matrix <T> *> & matrices)
 {
-    std::fstream is;
-    is.open (fileName, std::fstream::in/* | std::fstream::binary*/);
-
-    Matrix <T> * matrix = new Matrix <T>;
-    while (is >> * matrix) {
-        matrices.push_back (matrix);
-        matrix = new Matrix <T>;
+    MatrixFileWriter writer (binaryFileName);
+    for (size_t i = 0; i < matrices.size (); ++i) {
+        writer.add (* matrices [i]);
     }
-    delete matrix;
-    is.close ();
+    writer.close ();
 
     return true;
 }
 
 
 
+template <typename T>
+bool read (std::vector <Matrix <T> *> & matrices)
+{
+    // The binary set, when there is one, is mapped instead of parsed.
+    if (MatrixFile::is_matrix_file (binaryFileName) ) {
+        MatrixFile file (binaryFileName);
+        for (size_t i = 0; i < file.count (); ++i) {
+            matrices.push_back (new Matrix <T> (file.matrix <T> (i) ) );
+        }
+        return true;
+    }
+
+    // Otherwise the text set is read at once and parsed.
+    try {
+        return parse (MatrixText::read_file (fileName), matrices);
+    }
+    catch (const std::exception &) {
+        return false;
+    }
+}
+
+
+
 template <typename T>
 Matrix<double> generate_random_matrix (const size_t nrows, const size_t ncols)
 {
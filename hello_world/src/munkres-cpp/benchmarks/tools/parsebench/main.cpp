@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "matrixtext.h"
+#include "matrixutils.h"
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+
+
+static const std::string hostFileName   = "parsebench_host.txt";
+static const std::string streamFileName = "parsebench_matrices.txt";
+
+
+
+// Best of a few runs of parse, in seconds.
+template <typename Parse>
+static double best_time (Parse parse)
+{
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        const auto start = std::chrono::steady_clock::now ();
+        parse ();
+        const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - start).count ();
+        best = run ? std::min (best, seconds) : seconds;
+    }
+    return best;
+}
+
+
+
+static void report (const char * label, const size_t bytes, const double seconds, const double baseline)
+{
+    std::cout << std::setw (40) << std::left << label << std::setw (10) << std::right << std::fixed
+              << std::setprecision (1) << bytes / seconds / 1e6 << " MB/s" << std::setw (8)
+              << std::setprecision (2) << baseline / seconds << "x" << std::endl;
+}
+
+
+
+// Times the stream parsing the FPGA host and matrixutils.h did against
+// MatrixText on generated text of about the given size:
+//   matrixparsebench.bin <megabytes> [matrix size] [threads]
+int main (int argc, char * argv [])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv [0] << " <megabytes> [matrix size] [threads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const size_t bytes   = std::stoul (argv [1]) << 20;
+    const size_t size    = argc > 2 ? std::stoul (argv [2]) : 500;
+    const unsigned threads = argc > 3 ? std::stoul (argv [3]) : std::max (1u, std::thread::hardware_concurrency () );
+
+    // Costs with a few significant digits, as the host's inputs have them;
+    // the same matrices in the host's format and after a "Matrix (address)
+    // of RxC" line.
+    std::default_random_engine generator;
+    std::uniform_real_distribution <double> distribution (0.0, 100000.0);
+    std::string host, stream;
+    size_t matrices = 0;
+    while (host.size () < bytes) {
+        const std::string dimensions = std::to_string (size) + " " + std::to_string (size) + "\n";
+        host   += dimensions;
+        stream += "Matrix (0x" + std::to_string (matrices) + ") of " + std::to_string (size) + "x" + std::to_string (size) + "\n";
+        for (size_t row = 0; row < size; ++row) {
+            std::string line;
+            for (size_t col = 0; col < size; ++col) {
+                char value [32];
+                std::snprintf (value, sizeof (value), "%g ", distribution (generator) );
+                line += value;
+            }
+            line += "\n";
+            host   += line;
+            stream += line;
+        }
+        ++matrices;
+    }
+    std::ofstream (hostFileName)   << host;
+    std::ofstream (streamFileName) << stream;
+    std::cout << matrices << " matrices of " << size << "x" << size << ", " << host.size () / 1e6 << " MB of text, "
+              << threads << " threads" << std::endl;
+
+    // The host: operator >> on an ifstream, one value at a time.
+    std::vector <double> numbers;
+    const double host_stream = best_time ([&] () {
+        std::ifstream is (hostFileName);
+        numbers.clear ();
+        size_t rows, columns;
+        while (is >> rows >> columns) {
+            numbers.push_back (rows);
+            numbers.push_back (columns);
+            for (size_t i = 0; i < rows * columns; ++i) {
+                double value;
+                is >> value;
+                numbers.push_back (value);
+            }
+        }
+    });
+    const std::vector <double> etalon = numbers;
+    report ("host, ifstream >>", host.size (), host_stream, host_stream);
+    const double host_serial = best_time ([&] () { numbers = MatrixText::parse_file (hostFileName, 1); });
+    report ("host, MatrixText, 1 thread", host.size (), host_serial, host_stream);
+    const bool serial_same = numbers == etalon;
+    const double host_parallel = best_time ([&] () { numbers = MatrixText::parse_file (hostFileName, threads); });
+    report ("host, MatrixText, all threads", host.size (), host_parallel, host_stream);
+    const bool parallel_same = numbers == etalon;
+
+    // matrixutils.h: the former operator >> loop, then parse ().
+    std::vector <Matrix <double> *> parsed;
+    auto release = [&] () {
+        for (size_t i = 0; i < parsed.size (); ++i) {
+            delete parsed [i];
+        }
+        parsed.clear ();
+    };
+    const double utils_stream = best_time ([&] () {
+        release ();
+        std::ifstream is (streamFileName);
+        Matrix <double> * matrix = new Matrix <double>;
+        while (is >> * matrix) {
+            parsed.push_back (matrix);
+            matrix = new Matrix <double>;
+        }
+        delete matrix;
+    });
+    report ("matrixutils, operator >>", stream.size (), utils_stream, utils_stream);
+    std::vector <Matrix <double> > streamed;
+    for (size_t i = 0; i < parsed.size (); ++i) {
+        streamed.push_back (* parsed [i]);
+    }
+    const double utils_parse = best_time ([&] () {
+        release ();
+        parse (MatrixText::read_file (streamFileName), parsed);
+    });
+    report ("matrixutils, parse ()", stream.size (), utils_parse, utils_stream);
+    bool utils_same = parsed.size () == streamed.size () && parsed.size () == matrices;
+    for (size_t i = 0; utils_same && i < parsed.size (); ++i) {
+        for (size_t row = 0; row < size; ++row) {
+            for (size_t col = 0; col < size; ++col) {
+                utils_same = utils_same && (* parsed [i]) (row, col) == streamed [i] (row, col);
+            }
+        }
+    }
+    release ();
+
+    ::unlink (hostFileName.c_str () );
+    ::unlink (streamFileName.c_str () );
+    if (!serial_same || !parallel_same || !utils_same) {
+        std::cerr << "The parsers disagree" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#if !defined(_ASYNC_MUNKRES_H_)
+#define _ASYNC_MUNKRES_H_
+
+#include "matrix.h"
+#include "munkres.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ *
+ * Solves assignment problems on a pool of worker threads.
+ *
+ * Jobs are queued in a bounded FIFO: submit() blocks while the queue
+ * is full, which pushes back on the producer. Each worker owns one
+ * Munkres object and reuses it, together with its buffers, for all the
+ * jobs it runs.
+ *
+ */
+template<typename Data> class AsyncMunkres
+{
+public:
+    // Solution in the output format of Munkres::solve.
+    typedef Matrix<Data> Assignment;
+    typedef std::chrono::steady_clock Clock;
+
+    // Set on the future of a job that was still queued at its deadline.
+    class deadline_expired : public std::runtime_error {
+    public:
+        deadline_expired() : std::runtime_error("AsyncMunkres: deadline expired before the job started") {
+        }
+    };
+
+    struct Statistics {
+        size_t completed = 0;
+        size_t expired = 0;
+        // Time from submit() to a worker picking the job up.
+        Clock::duration total_queue_time = Clock::duration::zero();
+        Clock::duration max_queue_time = Clock::duration::zero();
+        // Time spent in Munkres::solve.
+        Clock::duration total_service_time = Clock::duration::zero();
+        Clock::duration max_service_time = Clock::duration::zero();
+    };
+
+    explicit AsyncMunkres(const size_t workers = std::thread::hardware_concurrency(),
+                          const size_t capacity = 64)
+      : capacity(capacity > 0 ? capacity : 1) {
+        const size_t count = workers > 0 ? workers : 1;
+        for ( size_t i = 0 ; i < count ; i++ ) {
+            threads.emplace_back(&AsyncMunkres::work, this);
+        }
+    }
+
+    AsyncMunkres(const AsyncMunkres &) = delete;
+    AsyncMunkres & operator= (const AsyncMunkres &) = delete;
+
+    /*
+     *
+     * Waits for the queued jobs to finish, then stops the workers.
+     *
+     */
+    ~AsyncMunkres() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        not_empty.notify_all();
+        for ( auto &thread : threads ) {
+            thread.join();
+        }
+    }
+
+    /*
+     *
+     * Queues matrix for solving, blocking while the queue is full.
+     * If the job hasn't started by deadline, it is dropped and the
+     * future throws deadline_expired.
+     *
+     */
+    std::future<Assignment> submit(Matrix<Data> &&matrix,
+                                   const Clock::time_point deadline = Clock::time_point::max()) {
+        Job job;
+        job.matrix = std::move(matrix);
+        job.deadline = deadline;
+        std::future<Assignment> result = job.promise.get_future();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return jobs.size() < capacity; });
+        job.submitted = Clock::now();
+        jobs.push_back(std::move(job));
+        lock.unlock();
+        not_empty.notify_one();
+
+        return result;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return jobs.size();
+    }
+
+    Statistics statistics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+
+  struct Job {
+    Matrix<Data> matrix;
+    std::promise<Assignment> promise;
+    Clock::time_point submitted;
+    Clock::time_point deadline;
+  };
+
+  void work() {
+    Munkres<Data> munkres;
+
+    for ( ;; ) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if ( jobs.empty() ) {
+          return;
+        }
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      not_full.notify_one();
+
+      const Clock::time_point started = Clock::now();
+      if ( started >= job.deadline ) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stats.expired++;
+        }
+        job.promise.set_exception(std::make_exception_ptr(deadline_expired()));
+        continue;
+      }
+
+      std::exception_ptr error;
+      try {
+        munkres.solve(job.matrix);
+      } catch ( ... ) {
+        error = std::current_exception();
+      }
+
+      // Account before fulfilling the promise, so that statistics()
+      // covers every job whose future is ready.
+      const Clock::time_point finished = Clock::now();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.completed++;
+        stats.total_queue_time += started - job.submitted;
+        stats.max_queue_time = std::max(stats.max_queue_time, started - job.submitted);
+        stats.total_service_time += finished - started;
+        stats.max_service_time = std::max(stats.max_service_time, finished - started);
+      }
+
+      if ( error ) {
+        job.promise.set_exception(error);
+      } else {
+        job.promise.set_value(std::move(job.matrix));
+      }
+    }
+  }
+
+  const size_t capacity;
+  std::vector<std::thread> threads;
+  std::deque<Job> jobs;
+  mutable std::mutex mutex;
+  std::condition_variable not_empty, not_full;
+  bool stopping = false;
+  Statistics stats;
+};
+
+
+#endif /* !defined(_ASYNC_MUNKRES_H_) */
@@ -0,0 +1,543 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#if !defined(_DYNAMIC_MUNKRES_H_)
+#define _DYNAMIC_MUNKRES_H_
+
+#include "matrix.h"
+#include "munkres.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <cassert>
+
+/*
+ *
+ * Linear assignment problem kept optimal under incremental changes.
+ *
+ * The solver keeps the assignment together with the row and column
+ * duals (u, v) such that cost(row,col) - u[row] - v[col] >= 0 holds
+ * everywhere and is 0 on the assigned pairs. A change only invalidates
+ * the duals of one row or column, which is repaired by a single
+ * shortest augmenting path (O(n^2)) instead of a full O(n^3) solve.
+ *
+ * Rectangular problems are padded to a square of size
+ * max(rows, columns) with zero cost dummy rows or columns, which are
+ * always the last ones.
+ *
+ * Munkres<Data>::infinity() marks a forbidden pair. As in
+ * Munkres::replace_infinites, it is solved as a cost one above the
+ * largest finite cost, so a row with no allowed column still gets one.
+ * Integer costs whose reduced values would overflow throw
+ * std::overflow_error.
+ *
+ */
+template<typename Data> class DynamicMunkres
+{
+public:
+    DynamicMunkres() {
+    }
+
+    explicit DynamicMunkres(const Matrix<Data> &m) {
+        nrows = m.rows();
+        ncolumns = m.columns();
+        const size_t size = std::max(nrows, ncolumns);
+
+        cost.assign(size, std::vector<Data>(size, 0));
+        for ( size_t row = 0 ; row < nrows ; row++ ) {
+            for ( size_t col = 0 ; col < ncolumns ; col++ ) {
+                cost[row][col] = m(row, col);
+                note_cost(cost[row][col]);
+            }
+        }
+        raised = false;
+
+        u.assign(size, 0);
+        v.assign(size, 0);
+        col_of_row.assign(size, -1);
+        row_of_col.assign(size, -1);
+
+        for ( size_t row = 0 ; row < size ; row++ ) {
+            u[row] = row_slack(row);
+            augment(row);
+        }
+    }
+
+    /*
+     *
+     * Appends a row; costs holds one value per column.
+     *
+     */
+    void add_row(const std::vector<Data> &costs) {
+        assert( costs.size() == ncolumns );
+
+        for ( size_t col = 0 ; col < ncolumns ; col++ ) {
+            note_cost(costs[col]);
+        }
+        if ( nrows < ncolumns ) {
+            // Overwrite the first dummy row.
+            const size_t row = nrows++;
+            std::copy(costs.begin(), costs.end(), cost[row].begin());
+            reset_row(row);
+        } else {
+            const size_t row = grow();
+            std::copy(costs.begin(), costs.end(), cost[row].begin());
+            nrows++;
+            v[row] = column_slack(row, row);
+            u[row] = row_slack(row);
+            augment(row);
+        }
+        reassign_forbidden();
+    }
+
+    /*
+     *
+     * Appends a column; costs holds one value per row.
+     *
+     */
+    void add_column(const std::vector<Data> &costs) {
+        assert( costs.size() == nrows );
+
+        for ( size_t row = 0 ; row < nrows ; row++ ) {
+            note_cost(costs[row]);
+        }
+        if ( ncolumns < nrows ) {
+            // Overwrite the first dummy column.
+            const size_t col = ncolumns++;
+            for ( size_t row = 0 ; row < nrows ; row++ ) {
+                cost[row][col] = costs[row];
+            }
+            reset_column(col);
+        } else {
+            const size_t col = grow();
+            for ( size_t row = 0 ; row < nrows ; row++ ) {
+                cost[row][col] = costs[row];
+            }
+            ncolumns++;
+            v[col] = column_slack(col, col);
+            u[col] = row_slack(col);
+            augment(col);
+        }
+        reassign_forbidden();
+    }
+
+    /*
+     *
+     * Removes a row; the following rows move up by one.
+     *
+     */
+    void remove_row(const size_t row) {
+        assert( row < nrows );
+
+        erase_row(row);
+        nrows--;
+
+        if ( nrows >= ncolumns ) {
+            // The square shrinks: drop the last dummy column as well.
+            const int freed_row = erase_last_column();
+            if ( freed_row >= 0 ) {
+                augment(freed_row);
+            }
+        } else {
+            // Keep the size with a new dummy row.
+            const size_t size = cost.size() + 1;
+            cost.push_back(std::vector<Data>(size, 0));
+            u.push_back(0);
+            col_of_row.push_back(-1);
+            u[size - 1] = row_slack(size - 1);
+            augment(size - 1);
+        }
+    }
+
+    /*
+     *
+     * Removes a column; the following columns move left by one.
+     *
+     */
+    void remove_column(const size_t col) {
+        assert( col < ncolumns );
+
+        const int freed_row = erase_column(col);
+        ncolumns--;
+
+        if ( ncolumns >= nrows ) {
+            // The square shrinks: drop the last dummy row as well.
+            const int freed_col = erase_row(cost.size() - 1);
+            if ( freed_col >= 0 ) {
+                augment(freed_row);
+            }
+        } else {
+            // Keep the size with a new dummy column.
+            const size_t size = cost.size();
+            for ( size_t row = 0 ; row < size ; row++ ) {
+                cost[row].push_back(0);
+            }
+            v.push_back(0);
+            row_of_col.push_back(-1);
+            v[size - 1] = column_slack(size - 1, size);
+            augment(freed_row);
+        }
+    }
+
+    void update_cost(const size_t row, const size_t col, const Data value) {
+        assert( row < nrows && col < ncolumns );
+
+        note_cost(value);
+        cost[row][col] = value;
+        if ( col_of_row[row] == static_cast<int>(col) || reduced_cost(row, col) < 0 ) {
+            reset_row(row);
+        }
+        reassign_forbidden();
+    }
+
+    size_t rows() const {
+        return nrows;
+    }
+
+    size_t columns() const {
+        return ncolumns;
+    }
+
+    /*
+     *
+     * Column assigned to row, or -1 if the row is left unassigned
+     * (only possible when there are more rows than columns).
+     *
+     */
+    int assignment(const size_t row) const {
+        assert( row < nrows );
+        return col_of_row[row] < static_cast<int>(ncolumns) ? col_of_row[row] : -1;
+    }
+
+    /*
+     *
+     * Sum of the assigned costs; Munkres<Data>::infinity() when a
+     * forbidden pair had to be assigned.
+     *
+     */
+    Data total_cost() const {
+        Data total = 0;
+        for ( size_t row = 0 ; row < nrows ; row++ ) {
+            if ( assignment(row) >= 0 ) {
+                if ( cost[row][col_of_row[row]] == Munkres<Data>::infinity() ) {
+                    return Munkres<Data>::infinity();
+                }
+                total += cost[row][col_of_row[row]];
+            }
+        }
+
+        return total;
+    }
+
+    /*
+     *
+     * Assignment in the output format of Munkres::solve:
+     * 0 for assigned pairs, -1 elsewhere.
+     *
+     */
+    Matrix<Data> solution() const {
+        if ( nrows == 0 || ncolumns == 0 ) {
+            return Matrix<Data>();
+        }
+
+        Matrix<Data> result(nrows, ncolumns);
+        for ( size_t row = 0 ; row < nrows ; row++ ) {
+            for ( size_t col = 0 ; col < ncolumns ; col++ ) {
+                result(row, col) = -1;
+            }
+            if ( assignment(row) >= 0 ) {
+                result(row, assignment(row)) = 0;
+            }
+        }
+
+        return result;
+    }
+
+    /*
+     *
+     * Number of augmenting paths computed so far.
+     * Every change costs at most one.
+     *
+     */
+    size_t augmentations() const {
+        return naugmentations;
+    }
+
+private:
+
+  // a + b and a - b, throwing where an integer Data would wrap (as
+  // Munkres::step5 does).
+  static Data add(const Data a, const Data b) {
+    if ( std::numeric_limits<Data>::is_integer &&
+         ( b > 0 ? a > std::numeric_limits<Data>::max() - b : a < std::numeric_limits<Data>::lowest() - b ) ) {
+      throw std::overflow_error("DynamicMunkres: cost overflow");
+    }
+
+    return a + b;
+  }
+
+  static Data subtract(const Data a, const Data b) {
+    if ( std::numeric_limits<Data>::is_integer &&
+         ( b < 0 ? a > std::numeric_limits<Data>::max() + b : a < std::numeric_limits<Data>::lowest() + b ) ) {
+      throw std::overflow_error("DynamicMunkres: cost overflow");
+    }
+
+    return a - b;
+  }
+
+  // Keeps forbidden above every finite cost given so far. Raising it
+  // makes the forbidden pairs dearer, which only matters to the rows
+  // assigned one: see reassign_forbidden().
+  void note_cost(const Data value) {
+    if ( value != Munkres<Data>::infinity() && !(value < forbidden) ) {
+      forbidden = add(value, 1);
+      raised = true;
+    }
+  }
+
+  // The cost the solver works with: forbidden pairs at forbidden.
+  Data solved_cost(const size_t row, const size_t col) const {
+    return cost[row][col] == Munkres<Data>::infinity() ? forbidden : cost[row][col];
+  }
+
+  Data reduced_cost(const size_t row, const size_t col) const {
+    return subtract(subtract(solved_cost(row, col), u[row]), v[col]);
+  }
+
+  // After forbidden was raised, the assigned forbidden pairs are no
+  // longer tight: their rows are freed first, so that every augmenting
+  // path runs over tight pairs only, then assigned again.
+  void reassign_forbidden() {
+    if ( !raised ) {
+      return;
+    }
+    raised = false;
+    std::vector<size_t> freed;
+    for ( size_t row = 0 ; row < cost.size() ; row++ ) {
+      if ( col_of_row[row] >= 0 && cost[row][col_of_row[row]] == Munkres<Data>::infinity() ) {
+        unassign(row);
+        freed.push_back(row);
+      }
+    }
+    for ( size_t row : freed ) {
+      u[row] = row_slack(row);
+      augment(row);
+    }
+  }
+
+  // Largest u[row] keeping row dual feasible.
+  Data row_slack(const size_t row) const {
+    const size_t size = cost.size();
+    Data min = Munkres<Data>::infinity();
+    for ( size_t col = 0 ; col < size ; col++ ) {
+      min = std::min<Data>(min, subtract(solved_cost(row, col), v[col]));
+    }
+
+    return min;
+  }
+
+  // Largest v[col] keeping col dual feasible over the first rows.
+  Data column_slack(const size_t col, const size_t rows) const {
+    Data min = rows > 0 ? Munkres<Data>::infinity() : 0;
+    for ( size_t row = 0 ; row < rows ; row++ ) {
+      min = std::min<Data>(min, subtract(solved_cost(row, col), u[row]));
+    }
+
+    return min;
+  }
+
+  // Adds one dummy row and one dummy column, returns their index.
+  size_t grow() {
+    const size_t size = cost.size();
+    for ( size_t row = 0 ; row < size ; row++ ) {
+      cost[row].push_back(0);
+    }
+    cost.push_back(std::vector<Data>(size + 1, 0));
+    u.push_back(0);
+    v.push_back(0);
+    col_of_row.push_back(-1);
+    row_of_col.push_back(-1);
+
+    return size;
+  }
+
+  void unassign(const size_t row) {
+    if ( col_of_row[row] >= 0 ) {
+      row_of_col[col_of_row[row]] = -1;
+      col_of_row[row] = -1;
+    }
+  }
+
+  void reset_row(const size_t row) {
+    unassign(row);
+    u[row] = row_slack(row);
+    augment(row);
+  }
+
+  void reset_column(const size_t col) {
+    const int row = row_of_col[col];
+    assert( row >= 0 );
+    unassign(row);
+    v[col] = column_slack(col, cost.size());
+    augment(row);
+  }
+
+  // Removes a row, returns the column it was assigned to or -1.
+  int erase_row(const size_t row) {
+    const int col = col_of_row[row];
+    unassign(row);
+
+    cost.erase(cost.begin() + row);
+    u.erase(u.begin() + row);
+    col_of_row.erase(col_of_row.begin() + row);
+    for ( size_t c = 0 ; c < row_of_col.size() ; c++ ) {
+      if ( row_of_col[c] > static_cast<int>(row) ) {
+        row_of_col[c]--;
+      }
+    }
+
+    return col;
+  }
+
+  // Removes a column, returns the row it was assigned to or -1.
+  int erase_column(const size_t col) {
+    const int row = row_of_col[col];
+    if ( row >= 0 ) {
+      unassign(row);
+    }
+
+    for ( size_t r = 0 ; r < cost.size() ; r++ ) {
+      cost[r].erase(cost[r].begin() + col);
+    }
+    v.erase(v.begin() + col);
+    row_of_col.erase(row_of_col.begin() + col);
+    for ( size_t r = 0 ; r < col_of_row.size() ; r++ ) {
+      if ( col_of_row[r] > static_cast<int>(col) ) {
+        col_of_row[r]--;
+      }
+    }
+
+    return row;
+  }
+
+  // Removes the last column, a dummy one whenever the square shrinks,
+  // returns the row it was assigned to or -1.
+  int erase_last_column() {
+    assert( !v.empty() );
+    return erase_column(v.size() - 1);
+  }
+
+  /*
+  Shortest Augmenting Path
+
+   1. Run Dijkstra on the reduced costs from the free row, through the
+      assigned pairs, until a free column (the sink) is reached.
+   2. Update the duals of the scanned rows and columns so that the
+      reduced costs stay non-negative and the path becomes tight.
+   3. Flip the assignment along the path.
+  */
+  void augment(const size_t start) {
+    const size_t size = cost.size();
+    const Data infinity = Munkres<Data>::infinity();
+
+    std::vector<Data> shortest(size, infinity);
+    std::vector<int> path(size, -1);
+    std::vector<char> scanned_row(size, 0), scanned_col(size, 0);
+    std::vector<size_t> remaining(size);
+    for ( size_t col = 0 ; col < size ; col++ ) {
+      remaining[col] = size - col - 1;
+    }
+
+    Data min_value = 0;
+    size_t row = start;
+    int sink = -1;
+    while ( sink == -1 ) {
+      scanned_row[row] = 1;
+      Data lowest = infinity;
+      size_t index = 0;
+      for ( size_t it = 0 ; it < remaining.size() ; it++ ) {
+        const size_t col = remaining[it];
+        const Data reduced = add(min_value, reduced_cost(row, col));
+        if ( reduced < shortest[col] ) {
+          path[col] = row;
+          shortest[col] = reduced;
+        }
+        if ( shortest[col] < lowest || ( !(lowest < shortest[col]) && row_of_col[col] == -1 ) ) {
+          lowest = shortest[col];
+          index = it;
+        }
+      }
+
+      // Every cost is finite, so only an overflow leaves no column
+      // reachable.
+      if ( !(lowest < infinity) ) {
+        throw std::overflow_error("DynamicMunkres: cost overflow");
+      }
+      min_value = lowest;
+      const size_t col = remaining[index];
+      if ( row_of_col[col] == -1 ) {
+        sink = col;
+      } else {
+        row = row_of_col[col];
+      }
+      scanned_col[col] = 1;
+      remaining[index] = remaining.back();
+      remaining.pop_back();
+    }
+
+    u[start] = add(u[start], min_value);
+    for ( size_t r = 0 ; r < size ; r++ ) {
+      if ( scanned_row[r] && r != start ) {
+        u[r] = add(u[r], min_value - shortest[col_of_row[r]]);
+      }
+    }
+    for ( size_t c = 0 ; c < size ; c++ ) {
+      if ( scanned_col[c] ) {
+        v[c] = subtract(v[c], min_value - shortest[c]);
+      }
+    }
+
+    int col = sink;
+    for ( ;; ) {
+      const int r = path[col];
+      row_of_col[col] = r;
+      std::swap(col_of_row[r], col);
+      if ( r == static_cast<int>(start) ) {
+        break;
+      }
+    }
+
+    naugmentations++;
+  }
+
+  std::vector<std::vector<Data> > cost;
+  std::vector<Data> u, v;
+  // The column assigned to each row and the row assigned to each
+  // column, -1 for none.
+  std::vector<int> col_of_row, row_of_col;
+  size_t nrows = 0, ncolumns = 0;
+  size_t naugmentations = 0;
+  // Cost of the forbidden pairs; raised tells it grew since the last
+  // reassign_forbidden().
+  Data forbidden = 1;
+  bool raised = false;
+};
+
+
+#endif /* !defined(_DYNAMIC_MUNKRES_H_) */
@@ -21,6 +21,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <algorithm>
+#include <utility>
 
 /*export*/ template <class T>
 Matrix<T>::Matrix() {
@@ -71,6 +72,17 @@ Matrix<T>::Matrix(const Matrix<T> &other) {
   }
 }
 
+/*export*/ template <class T>
+Matrix<T>::Matrix(Matrix<T> &&other) {
+  // take over the arrays, leave other empty
+  m_matrix = other.m_matrix;
+  m_rows = other.m_rows;
+  m_columns = other.m_columns;
+  other.m_matrix = nullptr;
+  other.m_rows = 0;
+  other.m_columns = 0;
+}
+
 /*export*/ template <class T>
 Matrix<T>::Matrix(const size_t rows, const size_t columns) {
   m_matrix = nullptr;
@@ -104,6 +116,19 @@ Matrix<T>::operator= (const Matrix<T> &other) {
   return *this;
 }
 
+/*export*/ template <class T>
+Matrix<T> &
+Matrix<T>::operator= (Matrix<T> &&other) {
+  if ( this != &other ) {
+    // swap arrays, other frees ours
+    std::swap(m_matrix, other.m_matrix);
+    std::swap(m_rows, other.m_rows);
+    std::swap(m_columns, other.m_columns);
+  }
+
+  return *this;
+}
+
 /*export*/ template <class T>
 Matrix<T>::~Matrix() {
   if ( m_matrix != nullptr ) {
@@ -122,6 +147,11 @@ void
 Matrix<T>::resize(const size_t rows, const size_t columns, const T default_value) {
   assert ( rows > 0 && columns > 0 && "Columns and rows must exist." );
 
+  if ( m_matrix != nullptr && rows == m_rows && columns == m_columns ) {
+    // nothing to do, keep the arrays
+    return;
+  }
+
   if ( m_matrix == nullptr ) {
     // alloc arrays
     m_matrix = new T*[rows]; // rows
@@ -30,7 +30,9 @@ public:
   Matrix(const size_t rows, const size_t columns);
   Matrix(const std::initializer_list<std::initializer_list<T>> init);
   Matrix(const Matrix<T> &other);
+  Matrix(Matrix<T> &&other);
   Matrix<T> & operator= (const Matrix<T> &other);
+  Matrix<T> & operator= (Matrix<T> &&other);
   ~Matrix();
   // all operations modify the matrix in-place.
   void resize(const size_t rows, const size_t columns, const T default_value = 0);
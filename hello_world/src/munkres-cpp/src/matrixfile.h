@@ -0,0 +1,280 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+
+#if !defined(_MATRIX_FILE_H_)
+#define _MATRIX_FILE_H_
+
+#include "matrix.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ *
+ * Binary container of cost matrices, read through a memory mapping so
+ * that no text is parsed and the costs are used where they lie.
+ *
+ * Layout, native byte order:
+ *   header (64 bytes): magic "MUNKRESM", version (uint32), dtype
+ *     (uint32), count (uint64), index offset (uint64), zero padding;
+ *   payloads: the costs of each matrix, row major and contiguous, each
+ *     starting on a 64 byte boundary;
+ *   index: count entries of rows, columns and payload offset (uint64).
+ * The index comes last so a writer streams the payloads out first.
+ *
+ */
+class MatrixFile
+{
+public:
+    enum Dtype : uint32_t { DOUBLE = 1, FLOAT = 2 };
+
+    static constexpr size_t ALIGNMENT = 64;
+
+    struct Entry {
+        uint64_t rows;
+        uint64_t columns;
+        uint64_t offset;
+    };
+
+    // Maps path read only; throws std::runtime_error when it is not a
+    // well formed matrix file.
+    explicit MatrixFile(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if ( fd < 0 ) {
+            throw std::runtime_error("MatrixFile: can't open " + path);
+        }
+        struct stat status;
+        if ( ::fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) < sizeof(Header) ) {
+            ::close(fd);
+            throw std::runtime_error("MatrixFile: " + path + " is too short");
+        }
+        bytes = status.st_size;
+        void *mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if ( mapped == MAP_FAILED ) {
+            throw std::runtime_error("MatrixFile: can't map " + path);
+        }
+        base = static_cast<const char *>(mapped);
+
+        const Header &header = *reinterpret_cast<const Header *>(base);
+        const size_t element = header.dtype == DOUBLE ? sizeof(double) : sizeof(float);
+        bool valid = std::memcmp(header.magic, signature(), sizeof(header.magic)) == 0 && header.version == VERSION &&
+                     (header.dtype == DOUBLE || header.dtype == FLOAT) &&
+                     header.index_offset % sizeof(uint64_t) == 0 && header.index_offset <= bytes &&
+                     header.count <= (bytes - header.index_offset) / sizeof(Entry);
+        if ( valid ) {
+            index = reinterpret_cast<const Entry *>(base + header.index_offset);
+            for ( size_t i = 0 ; i < header.count && valid ; i++ ) {
+                const Entry &entry = index[i];
+                valid = entry.offset % ALIGNMENT == 0 && entry.offset <= header.index_offset &&
+                        (entry.columns == 0 || entry.rows <= (header.index_offset - entry.offset) / element / entry.columns);
+            }
+        }
+        if ( !valid ) {
+            ::munmap(const_cast<char *>(base), bytes);
+            throw std::runtime_error("MatrixFile: " + path + " is not a valid matrix file");
+        }
+        matrices = header.count;
+        type = static_cast<Dtype>(header.dtype);
+    }
+
+    ~MatrixFile() {
+        ::munmap(const_cast<char *>(base), bytes);
+    }
+
+    MatrixFile(const MatrixFile &) = delete;
+    MatrixFile & operator= (const MatrixFile &) = delete;
+
+    // Whether path starts with the magic of a matrix file.
+    static bool is_matrix_file(const std::string &path) {
+        char magic[sizeof(Header::magic)] = {};
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if ( !file ) {
+            return false;
+        }
+        const bool match = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                           std::memcmp(magic, signature(), sizeof(magic)) == 0;
+        std::fclose(file);
+        return match;
+    }
+
+    size_t count() const { return matrices; }
+    Dtype dtype() const { return type; }
+    size_t rows(const size_t i) const { return index[i].rows; }
+    size_t columns(const size_t i) const { return index[i].columns; }
+
+    // The costs of matrix i where they are mapped, row major; T must be
+    // the file's dtype.
+    template<typename T> const T * data(const size_t i) const {
+        if ( dtype_of<T>() != type ) {
+            throw std::runtime_error("MatrixFile: matrices are stored with another dtype");
+        }
+        return reinterpret_cast<const T *>(base + index[i].offset);
+    }
+
+    // Copy of matrix i, converted to T.
+    template<typename T> Matrix<T> matrix(const size_t i) const {
+        Matrix<T> m(rows(i), columns(i));
+        for ( size_t row = 0 ; row < m.rows() ; row++ ) {
+            for ( size_t col = 0 ; col < m.columns() ; col++ ) {
+                m(row, col) = static_cast<T>(value(i, row * m.columns() + col));
+            }
+        }
+        return m;
+    }
+
+    template<typename T> static Dtype dtype_of();
+
+private:
+    friend class MatrixFileWriter;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t dtype;
+        uint64_t count;
+        uint64_t index_offset;
+        char padding[ALIGNMENT - 32];
+    };
+
+    static const char * signature() { return "MUNKRESM"; }
+    static constexpr uint32_t VERSION = 1;
+
+    double value(const size_t i, const size_t element) const {
+        const char *payload = base + index[i].offset;
+        return type == DOUBLE ? reinterpret_cast<const double *>(payload)[element]
+                              : reinterpret_cast<const float *>(payload)[element];
+    }
+
+    const char *base = nullptr;
+    size_t bytes = 0;
+    const Entry *index = nullptr;
+    size_t matrices = 0;
+    Dtype type = DOUBLE;
+};
+
+template<> inline MatrixFile::Dtype MatrixFile::dtype_of<double>() { return DOUBLE; }
+template<> inline MatrixFile::Dtype MatrixFile::dtype_of<float>() { return FLOAT; }
+
+
+
+/*
+ *
+ * Writes a MatrixFile one matrix at a time, converting the costs to the
+ * file's dtype; the header and the index are written by close().
+ *
+ */
+class MatrixFileWriter
+{
+public:
+    // Throws std::runtime_error when path can't be created.
+    MatrixFileWriter(const std::string &path, const MatrixFile::Dtype dtype = MatrixFile::DOUBLE)
+        : type(dtype) {
+        file = std::fopen(path.c_str(), "wb");
+        if ( !file ) {
+            throw std::runtime_error("MatrixFileWriter: can't create " + path);
+        }
+        MatrixFile::Header header;
+        std::memset(&header, 0, sizeof(header));
+        put(&header, sizeof(header));
+    }
+
+    ~MatrixFileWriter() {
+        if ( file ) {
+            std::fclose(file);
+        }
+    }
+
+    MatrixFileWriter(const MatrixFileWriter &) = delete;
+    MatrixFileWriter & operator= (const MatrixFileWriter &) = delete;
+
+    // Appends a rows x columns matrix, costs row major.
+    template<typename T> void add(const size_t rows, const size_t columns, const T *costs) {
+        pad();
+        index.push_back(MatrixFile::Entry{rows, columns, offset});
+        for ( size_t i = 0 ; i < rows * columns ; i++ ) {
+            if ( type == MatrixFile::DOUBLE ) {
+                const double value = static_cast<double>(costs[i]);
+                put(&value, sizeof(value));
+            } else {
+                const float value = static_cast<float>(costs[i]);
+                put(&value, sizeof(value));
+            }
+        }
+    }
+
+    template<typename T> void add(const Matrix<T> &m) {
+        std::vector<T> costs(m.rows() * m.columns());
+        for ( size_t row = 0 ; row < m.rows() ; row++ ) {
+            for ( size_t col = 0 ; col < m.columns() ; col++ ) {
+                costs[row * m.columns() + col] = m(row, col);
+            }
+        }
+        add(m.rows(), m.columns(), costs.data());
+    }
+
+    // Writes the index and the header; throws std::runtime_error if any
+    // write failed.
+    void close() {
+        pad();
+        MatrixFile::Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MatrixFile::signature(), sizeof(header.magic));
+        header.version = MatrixFile::VERSION;
+        header.dtype = type;
+        header.count = index.size();
+        header.index_offset = offset;
+        put(index.data(), sizeof(MatrixFile::Entry) * index.size());
+        const bool written = !failed && std::fseek(file, 0, SEEK_SET) == 0 &&
+                             std::fwrite(&header, sizeof(header), 1, file) == 1;
+        const bool closed = std::fclose(file) == 0;
+        file = nullptr;
+        if ( !written || !closed ) {
+            throw std::runtime_error("MatrixFileWriter: write failed");
+        }
+    }
+
+private:
+    void put(const void *data, const size_t size) {
+        if ( size && std::fwrite(data, size, 1, file) != 1 ) {
+            failed = true;
+        }
+        offset += size;
+    }
+
+    void pad() {
+        static const char zeros[MatrixFile::ALIGNMENT] = {};
+        put(zeros, (MatrixFile::ALIGNMENT - offset % MatrixFile::ALIGNMENT) % MatrixFile::ALIGNMENT);
+    }
+
+    FILE *file = nullptr;
+    MatrixFile::Dtype type;
+    std::vector<MatrixFile::Entry> index;
+    uint64_t offset = 0;
+    bool failed = false;
+};
+
+#endif /* !defined(_MATRIX_FILE_H_) */
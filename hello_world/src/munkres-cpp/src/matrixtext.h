@@ -0,0 +1,269 @@
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#if !defined(_MATRIX_TEXT_H_)
+#define _MATRIX_TEXT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ *
+ * Fast reader of cost matrices stored as text: the file is read whole,
+ * with a single read for regular files, and the numbers in it are parsed
+ * straight from the buffer, large buffers in parallel chunks.
+ *
+ * Numbers are separated by white space or commas. A decimal number of up
+ * to 19 significant digits whose value and power of ten are both exact
+ * in a double (most costs written with a few decimals) is converted with
+ * one multiplication or division, which rounds correctly; any other
+ * token goes to strtod.
+ *
+ */
+class MatrixText
+{
+public:
+    // Buffers smaller than this per thread are parsed on one thread.
+    static constexpr size_t MIN_CHUNK = 1 << 20;
+
+    // The contents of path; throws std::runtime_error when it can't be
+    // read.
+    static std::string read_file(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if ( fd < 0 ) {
+            throw std::runtime_error("MatrixText: can't open " + path);
+        }
+        // A regular file is sized first and read at once (reads again only
+        // when the kernel returns less); anything else grows the buffer
+        // until the end.
+        struct stat status;
+        const bool sized = ::fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0;
+        std::string text(sized ? status.st_size : 0, '\0');
+        size_t filled = 0;
+        while ( true ) {
+            if ( filled == text.size() ) {
+                if ( sized ) {
+                    break;
+                }
+                text.resize(std::max<size_t>(2 * text.size(), 1 << 16));
+            }
+            const ssize_t got = ::read(fd, &text[filled], text.size() - filled);
+            if ( got < 0 ) {
+                ::close(fd);
+                throw std::runtime_error("MatrixText: can't read " + path);
+            }
+            if ( got == 0 ) {
+                break;
+            }
+            filled += got;
+        }
+        ::close(fd);
+        text.resize(filled);
+        return text;
+    }
+
+    // Every number in [begin, end), in order, parsed on up to threads
+    // threads (0: one per hardware thread); throws std::runtime_error at
+    // the first token that is not a number.
+    static std::vector<double> parse(const char *begin, const char *end, unsigned threads = 0) {
+        if ( threads == 0 ) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const size_t size = end - begin;
+        const size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, size / MIN_CHUNK));
+
+        // Chunks end on a separator, so no number is split between two.
+        std::vector<const char *> bounds(chunks + 1, end);
+        bounds[0] = begin;
+        for ( size_t c = 1 ; c < chunks ; c++ ) {
+            const char *bound = std::max(begin + size / chunks * c, bounds[c - 1]);
+            while ( bound != end && !is_separator(*bound) ) {
+                bound++;
+            }
+            bounds[c] = bound;
+        }
+
+        // Count the tokens of every chunk, then parse each chunk straight
+        // into its place in the result.
+        std::vector<size_t> offsets(chunks + 1, 0);
+        run(chunks, [&](size_t c) { offsets[c + 1] = count(bounds[c], bounds[c + 1]); });
+        for ( size_t c = 0 ; c < chunks ; c++ ) {
+            offsets[c + 1] += offsets[c];
+        }
+        std::vector<double> numbers(offsets[chunks]);
+        run(chunks, [&](size_t c) { parse_chunk(bounds[c], bounds[c + 1], begin, numbers.data() + offsets[c]); });
+        return numbers;
+    }
+
+    // Every number in the file at path.
+    static std::vector<double> parse_file(const std::string &path, unsigned threads = 0) {
+        const std::string text = read_file(path);
+        return parse(text.data(), text.data() + text.size(), threads);
+    }
+
+    static bool is_separator(const char c) {
+        return c == ' ' || c == '\n' || c == ',' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Parses the token [begin, end) into value; false when it is not a
+    // number.
+    static bool parse_number(const char *begin, const char *end, double &value) {
+        const char *p = begin;
+        const bool negative = p != end && *p == '-';
+        if ( p != end && (*p == '-' || *p == '+') ) {
+            p++;
+        }
+        uint64_t mantissa = 0;
+        int digits = 0, exponent = 0;
+        bool exact = true, any = false;
+        for ( ; p != end && *p >= '0' && *p <= '9' ; p++ ) {
+            exact = append_digit(mantissa, digits, *p) && exact;
+            if ( digits > 19 ) {
+                exponent++;
+            }
+            any = true;
+        }
+        if ( p != end && *p == '.' ) {
+            for ( p++ ; p != end && *p >= '0' && *p <= '9' ; p++ ) {
+                exact = append_digit(mantissa, digits, *p) && exact;
+                if ( digits <= 19 ) {
+                    exponent--;
+                }
+                any = true;
+            }
+        }
+        if ( any && p != end && (*p == 'e' || *p == 'E') ) {
+            p++;
+            const bool negative_exponent = p != end && *p == '-';
+            if ( p != end && (*p == '-' || *p == '+') ) {
+                p++;
+            }
+            int written = 0;
+            bool exponent_digits = false;
+            for ( ; p != end && *p >= '0' && *p <= '9' ; p++ ) {
+                written = std::min(written * 10 + (*p - '0'), 100000);
+                exponent_digits = true;
+            }
+            any = exponent_digits;
+            exponent += negative_exponent ? -written : written;
+        }
+
+        if ( any && p == end && exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22 ) {
+            static const double powers[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            const double magnitude = exponent < 0 ? static_cast<double>(mantissa) / powers[-exponent]
+                                                  : static_cast<double>(mantissa) * powers[exponent];
+            value = negative ? -magnitude : magnitude;
+            return true;
+        }
+
+        // strtod wants a terminated string, and takes hexadecimal, inf,
+        // nan and the long mantissas.
+        const std::string token(begin, end);
+        char *stop = nullptr;
+        value = std::strtod(token.c_str(), &stop);
+        return !token.empty() && stop == token.c_str() + token.size();
+    }
+
+
+private:
+    // Appends a decimal digit to the mantissa while it has fewer than 19
+    // significant digits; false when a nonzero digit is dropped.
+    static bool append_digit(uint64_t &mantissa, int &digits, const char c) {
+        if ( digits >= 19 ) {
+            digits++;
+            return c == '0';
+        }
+        mantissa = mantissa * 10 + (c - '0');
+        if ( mantissa != 0 ) {
+            digits++;
+        }
+        return true;
+    }
+
+    static size_t count(const char *p, const char *end) {
+        size_t tokens = 0;
+        bool in_token = false;
+        for ( ; p != end ; p++ ) {
+            const bool separator = is_separator(*p);
+            tokens += !separator && !in_token;
+            in_token = !separator;
+        }
+        return tokens;
+    }
+
+    static void parse_chunk(const char *p, const char *end, const char *origin, double *out) {
+        while ( true ) {
+            while ( p != end && is_separator(*p) ) {
+                p++;
+            }
+            if ( p == end ) {
+                return;
+            }
+            const char *token = p;
+            while ( p != end && !is_separator(*p) ) {
+                p++;
+            }
+            if ( !parse_number(token, p, *out++) ) {
+                throw std::runtime_error("MatrixText: '" + std::string(token, std::min<size_t>(p - token, 32)) +
+                                         "' at offset " + std::to_string(token - origin) + " is not a number");
+            }
+        }
+    }
+
+    // Calls work(c) for every chunk c, the first on the calling thread;
+    // rethrows the first chunk's exception.
+    template<typename Work> static void run(const size_t chunks, Work work) {
+        std::vector<std::exception_ptr> errors(chunks);
+        std::vector<std::thread> workers;
+        for ( size_t c = 1 ; c < chunks ; c++ ) {
+            workers.emplace_back([&, c]() {
+                try {
+                    work(c);
+                } catch (...) {
+                    errors[c] = std::current_exception();
+                }
+            });
+        }
+        try {
+            work(0);
+        } catch (...) {
+            errors[0] = std::current_exception();
+        }
+        for ( auto &worker : workers ) {
+            worker.join();
+        }
+        for ( auto &error : errors ) {
+            if ( error ) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
+
+#endif /* !defined(_MATRIX_TEXT_H_) */
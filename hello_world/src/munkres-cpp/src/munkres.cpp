@@ -22,4 +22,5 @@
 template class Munkres<double>;
 template class Munkres<float>;
 template class Munkres<int>;
+template class Munkres<long long>;
 
@@ -23,10 +23,14 @@
 #include "matrix.h"
 
 #include <list>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 #include <utility>
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <stdexcept>
 
 template<typename Data> class Munkres
 {
@@ -35,6 +39,75 @@ template<typename Data> class Munkres
     static constexpr int PRIME  = 2;
 public:
 
+    /*
+     *
+     * Zero tolerance for floating point costs.
+     * Entries within epsilon of zero are handled as zeros by the
+     * zero search and skipped by the minimum search of step 5.
+     * If relative is set, epsilon is multiplied by the largest
+     * absolute finite value of the matrix on each solve.
+     * epsilon == 0 (the default) means exact comparisons.
+     *
+     */
+    void set_tolerance(const double epsilon, const bool relative = false) {
+        assert( epsilon >= 0 );
+        this->epsilon = epsilon;
+        this->relative_epsilon = relative;
+    }
+
+    /*
+     *
+     * Multiply costs by factor and round them to integers before
+     * solving, so that the additions and subtractions of step 5 are
+     * exact. The assignment is unaffected up to the rounding error
+     * (at most 0.5 / factor per cost).
+     * factor == 0 (the default) disables rescaling.
+     *
+     */
+    void set_integer_rescale(const double factor) {
+        assert( factor >= 0 );
+        this->rescale = factor;
+    }
+
+    /*
+     *
+     * Budget for anytime solving: the search stops after iterations
+     * passes through step 3 or once limit has elapsed since the start
+     * of solve, whichever comes first. The stars found so far are then
+     * completed greedily into a full assignment, see is_optimal() and
+     * lower_bound(). 0 (the default) means no limit.
+     *
+     */
+    void set_iteration_limit(const size_t iterations) {
+        this->iteration_limit = iterations;
+    }
+
+    void set_time_limit(const std::chrono::steady_clock::duration limit) {
+        this->time_limit = limit;
+    }
+
+    /*
+     *
+     * false if the last solve ran out of budget, in which case its
+     * assignment may be suboptimal.
+     *
+     */
+    bool is_optimal() const {
+        return optimal;
+    }
+
+    /*
+     *
+     * Dual lower bound on the cost of the optimal assignment of the
+     * last solve (with infinities replaced as in replace_infinites).
+     * The gap to the cost of the returned assignment bounds how far
+     * from optimal it is; it is 0 when is_optimal().
+     *
+     */
+    double lower_bound() const {
+        return dual_bound;
+    }
+
     /*
      *
      * Linear assignment problem solution
@@ -66,17 +139,14 @@ public:
 
 
         // STAR == 1 == starred, PRIME == 2 == primed
+        // The buffers are kept between calls, so that solving problems
+        // of the same size again with this object doesn't reallocate.
         mask_matrix.resize(size, size);
+        mask_matrix.clear();
 
-        row_mask = new bool[size];
-        col_mask = new bool[size];
-        for ( int i = 0 ; i < size ; i++ ) {
-            row_mask[i] = false;
-        }
-
-        for ( int i = 0 ; i < size ; i++ ) {
-            col_mask[i] = false;
-        }
+        row_mask.assign(size, false);
+        col_mask.assign(size, false);
+        col_bound.resize(size);
 
         // Prepare the matrix values...
 
@@ -84,9 +154,34 @@ public:
         // than the maximum value in the matrix.
         replace_infinites(matrix);
 
+        if ( rescale > 0 ) {
+            rescale_to_integers(matrix, rescale);
+        }
+
+        tolerance = relative_epsilon ? epsilon * max_abs(matrix) : epsilon;
+
+        // Whatever the duals subtracted from the costs, the diagonal
+        // entries lose u[i] + v[i]: the dual objective is the drop of
+        // the diagonal sum (see lower_bound()).
+        double diagonal = 0;
+        for ( int i = 0 ; i < size ; i++ ) {
+            diagonal += matrix(i, i);
+        }
+        // Every padding row or column adds its constant cost to any
+        // assignment of the square matrix.
+        const double padding = ( size - std::min(rows, columns) ) * static_cast<double>(matrix(size - 1, size - 1));
+
         minimize_along_direction(matrix, rows >= columns);
         minimize_along_direction(matrix, rows <  columns);
 
+        iterations = 0;
+        check_mask = 0;
+        while ( ( check_mask + 1 ) * size * size < 16384 ) {
+            check_mask = check_mask * 2 + 1;
+        }
+        deadline = std::chrono::steady_clock::now() + time_limit;
+        optimal = true;
+
         // Follow the steps
         int step = 1;
         while ( step ) {
@@ -101,7 +196,7 @@ public:
                 break;
             case 3:
                 step = step3();
-                // step in [3, 4, 5]
+                // step in [0, 3, 4, 5]: 0 when out of budget
                 break;
             case 4:
                 step = step4();
@@ -114,6 +209,18 @@ public:
             }
         }
 
+        if ( !optimal ) {
+            complete_greedily();
+        }
+
+        for ( int i = 0 ; i < size ; i++ ) {
+            diagonal -= matrix(i, i);
+        }
+        dual_bound = diagonal - padding;
+        if ( rescale > 0 ) {
+            dual_bound /= rescale;
+        }
+
         // Store results
         for ( int row = 0 ; row < size ; row++ ) {
             for ( int col = 0 ; col < size ; col++ ) {
@@ -133,17 +240,14 @@ public:
         matrix.resize(rows, columns);
 
         m = matrix;
-
-        delete [] row_mask;
-        delete [] col_mask;
     }
 
     static void replace_infinites(Matrix<Data> &matrix) {
       const int rows = matrix.rows(),
                 columns = matrix.columns();
       assert( rows > 0 && columns > 0 );
-      double max = matrix(0, 0);
-      constexpr auto infinity = std::numeric_limits<double>::infinity();
+      Data max = matrix(0, 0);
+      constexpr Data infinity = Munkres<Data>::infinity();
 
       // Find the greatest value in the matrix that isn't infinity.
       for ( int row = 0 ; row < rows ; row++ ) {
@@ -152,7 +256,7 @@ public:
             if ( max == infinity ) {
               max = matrix(row, col);
             } else {
-              max = std::max<double>(max, matrix(row, col));
+              max = std::max<Data>(max, matrix(row, col));
             }
           }
         }
@@ -183,13 +287,13 @@ public:
       // Look for a minimum value to subtract from all values along
       // the "outer" direction.
       for ( int i = 0 ; i < outer_size ; i++ ) {
-        double min = over_columns ? matrix(0, i) : matrix(i, 0);
+        Data min = over_columns ? matrix(0, i) : matrix(i, 0);
 
         // As long as the current minimum is greater than zero,
         // keep looking for the minimum.
         // Start at one because we already have the 0th value in min.
         for ( int j = 1 ; j < inner_size && min > 0 ; j++ ) {
-          min = std::min<double>(
+          min = std::min<Data>(
             min,
             over_columns ? matrix(j, i) : matrix(i, j));
         }
@@ -206,18 +310,126 @@ public:
       }
     }
 
+    /*
+     *
+     * Value standing for an infinite cost: infinity for floating point
+     * types, the largest representable value for integer types.
+     *
+     */
+    static constexpr Data infinity() {
+      return std::numeric_limits<Data>::has_infinity
+        ? std::numeric_limits<Data>::infinity()
+        : std::numeric_limits<Data>::max();
+    }
+
+    static void rescale_to_integers(Matrix<Data> &matrix, const double factor) {
+      const int rows = matrix.rows(),
+                columns = matrix.columns();
+
+      for ( int row = 0 ; row < rows ; row++ ) {
+        for ( int col = 0 ; col < columns ; col++ ) {
+          const double value = std::round(matrix(row, col) * factor);
+          if ( std::numeric_limits<Data>::is_integer
+               && std::fabs(value) >= static_cast<double>(std::numeric_limits<Data>::max()) ) {
+            throw std::overflow_error("Munkres: rescaled cost does not fit the cost type");
+          }
+          matrix(row, col) = value;
+        }
+      }
+    }
+
+    static double max_abs(const Matrix<Data> &matrix) {
+      const int rows = matrix.rows(),
+                columns = matrix.columns();
+      double max = 0;
+
+      for ( int row = 0 ; row < rows ; row++ ) {
+        for ( int col = 0 ; col < columns ; col++ ) {
+          max = std::max<double>(max, std::fabs(matrix(row, col)));
+        }
+      }
+
+      return max;
+    }
+
 private:
 
-  inline bool find_uncovered_in_matrix(const double item, int &row, int &col) const {
+  // Called once per step 3. A pass costs O(size^2), so the clock is
+  // read on every pass for large matrices and every few passes for
+  // small ones (check_mask + 1 passes).
+  inline bool out_of_budget() {
+    iterations++;
+    if ( iteration_limit > 0 && iterations > iteration_limit ) {
+      return true;
+    }
+
+    return time_limit > std::chrono::steady_clock::duration::zero()
+        && ( iterations & check_mask ) == 0
+        && std::chrono::steady_clock::now() >= deadline;
+  }
+
+  // Completes the stars into a full assignment, picking the free
+  // (row, column) pairs in increasing order of reduced cost.
+  void complete_greedily() {
+    const int size = matrix.rows();
+    std::vector<char> row_taken(size, false), col_taken(size, false);
+
+    for ( int row = 0 ; row < size ; row++ ) {
+      for ( int col = 0 ; col < size ; col++ ) {
+        if ( mask_matrix(row, col) == STAR ) {
+          row_taken[row] = col_taken[col] = true;
+        }
+      }
+    }
+
+    std::vector<std::pair<Data, std::pair<int,int> > > candidates;
+    for ( int row = 0 ; row < size ; row++ ) {
+      for ( int col = 0 ; col < size ; col++ ) {
+        if ( !row_taken[row] && !col_taken[col] ) {
+          candidates.push_back(std::make_pair(matrix(row, col), std::make_pair(row, col)));
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for ( size_t i = 0 ; i < candidates.size() ; i++ ) {
+      const int row = candidates[i].second.first,
+                col = candidates[i].second.second;
+      if ( !row_taken[row] && !col_taken[col] ) {
+        mask_matrix(row, col) = STAR;
+        row_taken[row] = col_taken[col] = true;
+      }
+    }
+  }
+
+  inline bool is_zero(const Data value) const {
+    // Same as value == 0 when tolerance is 0.
+    // Non short-circuit form, so that callers' loops stay branch free.
+    return (value <= tolerance) & (value >= -tolerance);
+  }
+
+  inline bool find_uncovered_in_matrix(const Data item, int &row, int &col) const {
     const int rows = matrix.rows(),
               columns = matrix.columns();
+    // Columns are first tested a block at a time with a branch free
+    // reduction, which vectorizes; only a block holding a match is
+    // scanned again to locate it.
+    constexpr int block = 16;
 
     for ( row = 0 ; row < rows ; row++ ) {
       if ( !row_mask[row] ) {
-        for ( col = 0 ; col < columns ; col++ ) {
-          if ( !col_mask[col] ) {
-            if ( matrix(row,col) == item ) {
-              return true;
+        const Data *line = &matrix(row, 0);
+        for ( int start = 0 ; start < columns ; start += block ) {
+          const int end = std::min(start + block, columns);
+          int hit = 0;
+          for ( int c = start ; c < end ; c++ ) {
+            hit |= (col_mask[c] == 0) & is_zero(line[c] - item);
+          }
+          if ( hit ) {
+            for ( col = start ; col < end ; col++ ) {
+              if ( !col_mask[col] && is_zero(line[col] - item) ) {
+                return true;
+              }
             }
           }
         }
@@ -243,7 +455,7 @@ private:
 
     for ( int row = 0 ; row < rows ; row++ ) {
       for ( int col = 0 ; col < columns ; col++ ) {
-        if ( 0 == matrix(row, col) ) {
+        if ( is_zero(matrix(row, col)) ) {
           for ( int nrow = 0 ; nrow < row ; nrow++ )
             if ( STAR == mask_matrix(nrow,col) )
               goto next_column;
@@ -295,6 +507,12 @@ private:
      2. If No Z* exists in the row of the Z', go to Step 4.
      3. If a Z* exists, cover this row and uncover the column of the Z*. Return to Step 3.1 to find a new Z
     */
+    if ( out_of_budget() ) {
+      // The stars still form a valid partial assignment here.
+      optimal = false;
+      return 0;
+    }
+
     if ( find_uncovered_in_matrix(0, saverow, savecol) ) {
       mask_matrix(saverow,savecol) = PRIME; // prime it.
     } else {
@@ -421,31 +639,45 @@ private:
      3. Subtract h from all uncovered columns
      4. Return to Step 3, without altering stars, primes, or covers.
     */
-    double h = std::numeric_limits<double>::max();
+    // The loops below are branch free and walk the rows contiguously,
+    // so that they vectorize (8 ints or 4 doubles per AVX2 register).
+    // col_bound holds the neutral element of the minimum for covered
+    // columns. Uncovered entries can't be zero here: step 3 found none.
+    constexpr Data none = std::numeric_limits<Data>::max(),
+                   lowest = std::numeric_limits<Data>::lowest();
+    for ( int col = 0 ; col < columns ; col++ ) {
+      col_bound[col] = col_mask[col] ? none : lowest;
+    }
+
+    Data h = none;
     for ( int row = 0 ; row < rows ; row++ ) {
       if ( !row_mask[row] ) {
+        const Data *line = &matrix(row, 0);
         for ( int col = 0 ; col < columns ; col++ ) {
-          if ( !col_mask[col] ) {
-            if ( h > matrix(row, col) && matrix(row, col) != 0 ) {
-              h = matrix(row, col);
-            }
-          }
+          h = std::min<Data>(h, std::max<Data>(line[col], col_bound[col]));
         }
       }
     }
 
     for ( int row = 0 ; row < rows ; row++ ) {
+      Data *line = &matrix(row, 0);
       if ( row_mask[row] ) {
+        if ( std::numeric_limits<Data>::is_integer ) {
+          // Only the covered columns of a covered row grow by h.
+          Data max = lowest;
+          for ( int col = 0 ; col < columns ; col++ ) {
+            max = std::max<Data>(max, std::min<Data>(line[col], col_bound[col]));
+          }
+          if ( max > none - h ) {
+            throw std::overflow_error("Munkres: cost overflow in step 5");
+          }
+        }
         for ( int col = 0 ; col < columns ; col++ ) {
-          matrix(row, col) += h;
+          line[col] += col_mask[col] ? h : 0;
         }
-      }
-    }
-
-    for ( int col = 0 ; col < columns ; col++ ) {
-      if ( !col_mask[col] ) {
-        for ( int row = 0 ; row < rows ; row++ ) {
-          matrix(row, col) -= h;
+      } else {
+        for ( int col = 0 ; col < columns ; col++ ) {
+          line[col] -= col_mask[col] ? 0 : h;
         }
       }
     }
@@ -455,9 +687,20 @@ private:
 
   Matrix<int> mask_matrix;
   Matrix<Data> matrix;
-  bool *row_mask;
-  bool *col_mask;
+  // Stored as char rather than bool: the compiler vectorizes byte
+  // loads of char but not of bool.
+  std::vector<char> row_mask;
+  std::vector<char> col_mask;
+  std::vector<Data> col_bound;
   int saverow = 0, savecol = 0;
+  double epsilon = 0, rescale = 0;
+  Data tolerance = 0;
+  bool relative_epsilon = false;
+  size_t iteration_limit = 0, iterations = 0, check_mask = 0;
+  std::chrono::steady_clock::duration time_limit = std::chrono::steady_clock::duration::zero();
+  std::chrono::steady_clock::time_point deadline;
+  bool optimal = true;
+  double dual_bound = 0;
 };
 
 
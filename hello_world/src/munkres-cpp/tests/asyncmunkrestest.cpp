@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "asyncmunkres.h"
+#include "munkres.h"
+#include "matrixtest.h"
+#include <vector>
+#include <random>
+
+
+
+class AsyncMunkresTest : public ::testing::Test
+{
+    protected:
+        Matrix <double> randomMatrix (const size_t, const size_t);
+
+        std::mt19937 generator {7};
+};
+
+
+
+Matrix <double> AsyncMunkresTest::randomMatrix (const size_t rows, const size_t columns)
+{
+  std::uniform_int_distribution <int> distribution (0, 99);
+  Matrix <double> matrix (rows, columns);
+  for ( size_t row = 0 ; row < rows ; row++ )
+    for ( size_t col = 0 ; col < columns ; col++ )
+      matrix (row, col) = distribution (generator);
+
+  return matrix;
+}
+
+
+
+TEST_F (AsyncMunkresTest, submit_3x3_ObviousSolution_Success)
+{
+  // Arrange.
+  Matrix <double> etalon_matrix {
+    {-1.0,  0.0, -1.0},
+    { 0.0, -1.0, -1.0},
+    {-1.0, -1.0,  0.0}
+  };
+  AsyncMunkres <double> solver (2, 4);
+
+  // Act.
+  std::future <Matrix <double> > result = solver.submit (Matrix <double> {
+    {1.0,  0.0,  1.0},
+    {0.0,  1.0,  1.0},
+    {1.0,  1.0,  0.0}
+  });
+
+  // Assert.
+  EXPECT_EQ (etalon_matrix, result.get () );
+}
+
+
+
+TEST_F (AsyncMunkresTest, submit_ManyJobs_MatchSynchronousSolve_Success)
+{
+  // Arrange.
+  AsyncMunkres <double> solver (3, 2);
+  std::vector <Matrix <double> > etalon_matrices;
+  std::vector <std::future <Matrix <double> > > results;
+  Munkres <double> munkres;
+
+  // Act.
+  for ( size_t i = 0 ; i < 40 ; i++ ) {
+    Matrix <double> matrix = randomMatrix (10 + i % 7, 10 + i % 5);
+    Matrix <double> etalon_matrix = matrix;
+    munkres.solve (etalon_matrix);
+    etalon_matrices.push_back (etalon_matrix);
+    results.push_back (solver.submit (std::move (matrix) ) );
+  }
+
+  // Assert.
+  for ( size_t i = 0 ; i < results.size () ; i++ )
+    EXPECT_EQ (etalon_matrices [i], results [i].get () );
+  EXPECT_EQ (40u, solver.statistics ().completed);
+  EXPECT_EQ (0u, solver.statistics ().expired);
+  EXPECT_EQ (0u, solver.pending () );
+}
+
+
+
+TEST_F (AsyncMunkresTest, submit_ExpiredDeadline_Fail)
+{
+  // Arrange.
+  AsyncMunkres <double> solver (1, 4);
+  const AsyncMunkres <double>::Clock::time_point deadline = AsyncMunkres <double>::Clock::now ();
+
+  // Act.
+  std::future <Matrix <double> > result = solver.submit (randomMatrix (5, 5), deadline);
+
+  // Assert.
+  EXPECT_THROW (result.get (), AsyncMunkres <double>::deadline_expired);
+  EXPECT_EQ (0u, solver.statistics ().completed);
+  EXPECT_EQ (1u, solver.statistics ().expired);
+}
@@ -0,0 +1,313 @@
+#include <gtest/gtest.h>
+#include "dynamicmunkres.h"
+#include "munkres.h"
+#include "matrixtest.h"
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+
+class DynamicMunkresTest : public ::testing::Test
+{
+    protected:
+        typedef std::vector <std::vector <double> > Costs;
+
+        std::vector <double> randomCosts   (const size_t);
+        Matrix <double>      toMatrix      (const Costs &);
+        double               referenceCost (const Costs &);
+        double               solutionCost  (const Costs &, const Matrix <double> &);
+
+        std::mt19937 generator {42};
+};
+
+
+
+std::vector <double> DynamicMunkresTest::randomCosts (const size_t size)
+{
+  // Integer valued costs keep the comparisons with the reference exact.
+  std::uniform_int_distribution <int> distribution (0, 99);
+  std::vector <double> costs (size);
+  for ( size_t i = 0 ; i < size ; i++ )
+    costs [i] = distribution (generator);
+
+  return costs;
+}
+
+
+
+Matrix <double> DynamicMunkresTest::toMatrix (const Costs & costs)
+{
+  Matrix <double> matrix (costs.size (), costs [0].size ());
+  for ( size_t row = 0 ; row < matrix.rows () ; row++ )
+    for ( size_t col = 0 ; col < matrix.columns () ; col++ )
+      matrix (row, col) = costs [row][col];
+
+  return matrix;
+}
+
+
+
+double DynamicMunkresTest::solutionCost (const Costs & costs, const Matrix <double> & solution)
+{
+  double total = 0;
+  for ( size_t row = 0 ; row < solution.rows () ; row++ )
+    for ( size_t col = 0 ; col < solution.columns () ; col++ )
+      if ( solution (row, col) == 0 )
+        total += costs [row][col];
+
+  return total;
+}
+
+
+
+double DynamicMunkresTest::referenceCost (const Costs & costs)
+{
+  Matrix <double> matrix = toMatrix (costs);
+  Munkres <double> munkres;
+  munkres.solve (matrix);
+
+  return solutionCost (costs, matrix);
+}
+
+
+
+TEST_F (DynamicMunkresTest, construct_20x20_MatchesMunkres_Success)
+{
+  // Arrange.
+  Costs costs;
+  for ( size_t row = 0 ; row < 20 ; row++ )
+    costs.push_back (randomCosts (20) );
+
+  // Act.
+  DynamicMunkres <double> solver (toMatrix (costs) );
+
+  // Assert.
+  EXPECT_EQ (referenceCost (costs), solver.total_cost () );
+  EXPECT_EQ (referenceCost (costs), solutionCost (costs, solver.solution () ) );
+}
+
+
+
+TEST_F (DynamicMunkresTest, construct_3x5_MatchesMunkres_Success)
+{
+  // Arrange.
+  Costs costs;
+  for ( size_t row = 0 ; row < 3 ; row++ )
+    costs.push_back (randomCosts (5) );
+
+  // Act.
+  DynamicMunkres <double> solver (toMatrix (costs) );
+
+  // Assert.
+  EXPECT_EQ (referenceCost (costs), solver.total_cost () );
+}
+
+
+
+TEST_F (DynamicMunkresTest, add_row_3x3_ObviousSolution_Success)
+{
+  // Arrange.
+  Matrix <double> etalon_matrix {
+    {-1.0,  0.0, -1.0},
+    { 0.0, -1.0, -1.0},
+    {-1.0, -1.0,  0.0}
+  };
+  DynamicMunkres <double> solver (Matrix <double> {
+    {1.0,  0.0,  1.0},
+    {0.0,  1.0,  1.0}
+  });
+
+  // Act.
+  solver.add_row ({1.0, 1.0, 0.0});
+
+  // Assert.
+  EXPECT_EQ (etalon_matrix, solver.solution () );
+  EXPECT_EQ (0.0, solver.total_cost () );
+}
+
+
+
+TEST_F (DynamicMunkresTest, remove_column_3x3_LeavesRowUnassigned_Success)
+{
+  // Arrange.
+  DynamicMunkres <double> solver (Matrix <double> {
+    {1.0,  0.0,  1.0},
+    {0.0,  1.0,  1.0},
+    {1.0,  1.0,  0.0}
+  });
+
+  // Act.
+  solver.remove_column (2);
+
+  // Assert.
+  EXPECT_EQ (2u, solver.columns () );
+  EXPECT_EQ (1, solver.assignment (0) );
+  EXPECT_EQ (0, solver.assignment (1) );
+  EXPECT_EQ (-1, solver.assignment (2) );
+}
+
+
+
+TEST_F (DynamicMunkresTest, random_changes_MatchMunkresWithOneAugmentationEach_Success)
+{
+  // Arrange.
+  Costs costs;
+  for ( size_t row = 0 ; row < 8 ; row++ )
+    costs.push_back (randomCosts (8) );
+  DynamicMunkres <double> solver (toMatrix (costs) );
+  std::uniform_int_distribution <int> operation (0, 4);
+
+  for ( int i = 0 ; i < 300 ; i++ ) {
+    const size_t rows = costs.size (), columns = costs [0].size ();
+    const size_t augmentations = solver.augmentations ();
+
+    // Act.
+    switch ( operation (generator) ) {
+    case 0:
+      if ( rows < 16 ) {
+        costs.push_back (randomCosts (columns) );
+        solver.add_row (costs.back () );
+      }
+      break;
+    case 1:
+      if ( rows > 1 ) {
+        const size_t row = generator () % rows;
+        costs.erase (costs.begin () + row);
+        solver.remove_row (row);
+      }
+      break;
+    case 2:
+      if ( columns < 16 ) {
+        const std::vector <double> column = randomCosts (rows);
+        for ( size_t row = 0 ; row < rows ; row++ )
+          costs [row].push_back (column [row]);
+        solver.add_column (column);
+      }
+      break;
+    case 3:
+      if ( columns > 1 ) {
+        const size_t col = generator () % columns;
+        for ( size_t row = 0 ; row < rows ; row++ )
+          costs [row].erase (costs [row].begin () + col);
+        solver.remove_column (col);
+      }
+      break;
+    case 4:
+      {
+        const size_t row = generator () % rows, col = generator () % columns;
+        costs [row][col] = randomCosts (1) [0];
+        solver.update_cost (row, col, costs [row][col]);
+      }
+      break;
+    }
+
+    // Assert.
+    ASSERT_EQ (costs.size (), solver.rows () );
+    ASSERT_EQ (costs [0].size (), solver.columns () );
+    ASSERT_LE (solver.augmentations (), augmentations + 1);
+    ASSERT_EQ (referenceCost (costs), solver.total_cost () );
+  }
+}
+
+
+
+TEST_F (DynamicMunkresTest, add_row_AllInfinite_RowLeftUnassigned_Success)
+{
+  // Arrange.
+  const double infinity = Munkres <double>::infinity ();
+  DynamicMunkres <double> solver (Matrix <double> {
+    {1.0,  0.0,  1.0},
+    {0.0,  1.0,  1.0},
+    {1.0,  1.0,  0.0}
+  });
+
+  // Act.
+  solver.add_row ({infinity, infinity, infinity});
+
+  // Assert.
+  EXPECT_EQ (4u, solver.rows () );
+  EXPECT_EQ (-1, solver.assignment (3) );
+  EXPECT_EQ (0.0, solver.total_cost () );
+}
+
+
+
+TEST_F (DynamicMunkresTest, add_row_AllInfiniteInDummyRow_ForbiddenPairAssigned_Success)
+{
+  // Arrange.
+  const double infinity = Munkres <double>::infinity ();
+  DynamicMunkres <double> solver (Matrix <double> {
+    {1.0,  0.0,  1.0},
+    {0.0,  1.0,  1.0}
+  });
+
+  // Act.
+  solver.add_row ({infinity, infinity, infinity});
+
+  // Assert.
+  EXPECT_EQ (1, solver.assignment (0) );
+  EXPECT_EQ (0, solver.assignment (1) );
+  EXPECT_EQ (2, solver.assignment (2) );
+  EXPECT_EQ (infinity, solver.total_cost () );
+}
+
+
+
+TEST_F (DynamicMunkresTest, add_row_AllInfiniteInteger_ForbiddenPairAssigned_Success)
+{
+  // Arrange.
+  const int infinity = Munkres <int>::infinity ();
+  DynamicMunkres <int> solver (Matrix <int> {
+    {5, 0, 2},
+    {0, 5, 2}
+  });
+
+  // Act.
+  solver.add_row ({infinity, infinity, infinity});
+
+  // Assert.
+  EXPECT_EQ (1, solver.assignment (0) );
+  EXPECT_EQ (0, solver.assignment (1) );
+  EXPECT_EQ (2, solver.assignment (2) );
+  EXPECT_EQ (infinity, solver.total_cost () );
+
+  // A finite cost for the row takes the forbidden pair's place.
+  solver.update_cost (2, 0, 1);
+  EXPECT_EQ (3, solver.total_cost () );
+}
+
+
+
+TEST_F (DynamicMunkresTest, update_cost_Infinite_MatchesMunkres_Success)
+{
+  // Arrange.
+  const double infinity = Munkres <double>::infinity ();
+  Costs costs;
+  for ( size_t row = 0 ; row < 8 ; row++ )
+    costs.push_back (randomCosts (8) );
+  DynamicMunkres <double> solver (toMatrix (costs) );
+
+  for ( size_t i = 0 ; i < 16 ; i++ ) {
+    // Act: forbid an assigned pair, so every change moves the assignment.
+    const size_t row = i % 8;
+    costs [row][solver.assignment (row)] = infinity;
+    solver.update_cost (row, solver.assignment (row), infinity);
+
+    // Assert.
+    ASSERT_EQ (referenceCost (costs), solver.total_cost () );
+  }
+}
+
+
+
+TEST_F (DynamicMunkresTest, construct_IntegerOverflow_Throws)
+{
+  // Arrange.
+  const int highest = std::numeric_limits <int>::max () - 1,
+            lowest  = std::numeric_limits <int>::lowest () + 1;
+
+  // Act, Assert.
+  EXPECT_THROW (DynamicMunkres <int> (Matrix <int> {{highest, lowest}, {lowest, highest}}), std::overflow_error);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "matrixfile.h"
+#include "matrixtest.h"
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+
+
+class MatrixFileTest : public ::testing::Test
+{
+    protected:
+        virtual void TearDown ();
+
+        const std::string path {"matrixfiletest.bin"};
+};
+
+
+
+void MatrixFileTest::TearDown ()
+{
+  ::unlink (path.c_str () );
+}
+
+
+
+TEST_F (MatrixFileTest, write_TwoMatricesOfDoubles_MappedBackUnchanged)
+{
+  // Arrange.
+  Matrix <double> etalon_first {
+    {1.0, 2.0, 3.0},
+    {4.0, 5.5, 6.0}
+  };
+  Matrix <double> etalon_second {
+    {7.0,  8.0},
+    {9.0, 10.0}
+  };
+
+  // Act.
+  MatrixFileWriter writer (path);
+  writer.add (etalon_first);
+  writer.add (etalon_second);
+  writer.close ();
+  MatrixFile file (path);
+
+  // Assert.
+  EXPECT_TRUE (MatrixFile::is_matrix_file (path) );
+  EXPECT_EQ (2u, file.count () );
+  EXPECT_EQ (MatrixFile::DOUBLE, file.dtype () );
+  EXPECT_EQ (2u, file.rows (0) );
+  EXPECT_EQ (3u, file.columns (0) );
+  EXPECT_EQ (etalon_first, file.matrix <double> (0) );
+  EXPECT_EQ (etalon_second, file.matrix <double> (1) );
+  EXPECT_EQ (5.5, file.data <double> (0) [4]);
+}
+
+
+
+TEST_F (MatrixFileTest, write_Payloads_AlignedForTheSolver)
+{
+  // Arrange.
+  const double costs [] = {1.0, 2.0, 3.0};
+
+  // Act.
+  MatrixFileWriter writer (path);
+  writer.add (1, 3, costs);
+  writer.add (3, 1, costs);
+  writer.close ();
+  MatrixFile file (path);
+
+  // Assert.
+  for (size_t i = 0; i < file.count (); ++i) {
+    EXPECT_EQ (0u, reinterpret_cast <uintptr_t> (file.data <double> (i) ) % MatrixFile::ALIGNMENT);
+  }
+}
+
+
+
+TEST_F (MatrixFileTest, write_FloatDtype_ConvertedOnRead)
+{
+  // Arrange.
+  Matrix <double> etalon_matrix {
+    {0.5, 1.0},
+    {2.0, 4.0}
+  };
+
+  // Act.
+  MatrixFileWriter writer (path, MatrixFile::FLOAT);
+  writer.add (etalon_matrix);
+  writer.close ();
+  MatrixFile file (path);
+
+  // Assert.
+  EXPECT_EQ (MatrixFile::FLOAT, file.dtype () );
+  EXPECT_EQ (etalon_matrix, file.matrix <double> (0) );
+  EXPECT_THROW (file.data <double> (0), std::runtime_error);
+}
+
+
+
+TEST_F (MatrixFileTest, open_TextFile_Throws)
+{
+  // Arrange.
+  std::ofstream text (path);
+  text << "2 2\n1 2\n3 4\n" << std::string (64, ' ');
+  text.close ();
+
+  // Act, Assert.
+  EXPECT_FALSE (MatrixFile::is_matrix_file (path) );
+  EXPECT_THROW (MatrixFile file (path), std::runtime_error);
+}
+
+
+
+TEST_F (MatrixFileTest, open_TruncatedFile_Throws)
+{
+  // Arrange.
+  const double costs [] = {1.0, 2.0, 3.0, 4.0};
+  MatrixFileWriter writer (path);
+  writer.add (2, 2, costs);
+  writer.close ();
+  ASSERT_EQ (0, ::truncate (path.c_str (), 96) );
+
+  // Act, Assert.
+  EXPECT_THROW (MatrixFile file (path), std::runtime_error);
+}
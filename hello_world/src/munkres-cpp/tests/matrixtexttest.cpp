@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "matrixtext.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+
+
+class MatrixTextTest : public ::testing::Test
+{
+    protected:
+        virtual void TearDown ();
+
+        static std::vector <double> parse (const std::string & text, const unsigned threads = 1)
+        {
+            return MatrixText::parse (text.data (), text.data () + text.size (), threads);
+        }
+
+        const std::string path {"matrixtexttest.txt"};
+};
+
+
+
+void MatrixTextTest::TearDown ()
+{
+  ::unlink (path.c_str () );
+}
+
+
+
+TEST_F (MatrixTextTest, parse_HostAndListingFormats_NumbersInOrder)
+{
+  // Arrange.
+  const std::string text = "2 3\n1 -2.5 +3\r\n4e2 0.0625 1E-3\n   5.5,  6,\n\t-0.75,";
+
+  // Act.
+  const std::vector <double> numbers = parse (text);
+
+  // Assert.
+  const std::vector <double> etalon {2.0, 3.0, 1.0, -2.5, 3.0, 400.0, 0.0625, 0.001, 5.5, 6.0, -0.75};
+  EXPECT_EQ (etalon, numbers);
+}
+
+
+
+TEST_F (MatrixTextTest, parse_AnyWrittenDouble_SameAsStrtod)
+{
+  // Arrange.
+  std::default_random_engine generator;
+  std::uniform_real_distribution <double> costs (-1e6, 1e6);
+  std::uniform_int_distribution <int> exponents (-300, 300);
+  const char * formats [] = {"%.17g", "%g", "%.3f", "%.0f", "%.25e"};
+  std::string text;
+  for (int i = 0; i < 5000; ++i) {
+    char value [64];
+    const double cost = i % 2 ? costs (generator) : std::ldexp (costs (generator), exponents (generator) );
+    std::snprintf (value, sizeof (value), formats [i % 5], cost);
+    text += value;
+    text += ' ';
+  }
+  text += "123456789012345678901234567890 0.000000000000000000000000001 1e400 inf";
+
+  // Act.
+  const std::vector <double> numbers = parse (text);
+
+  // Assert.
+  const char * p = text.c_str ();
+  for (size_t i = 0; i < numbers.size (); ++i) {
+    char * stop;
+    const double etalon = std::strtod (p, & stop);
+    ASSERT_EQ (etalon, numbers [i]) << "token " << i << ": " << std::string (p, static_cast <const char *> (stop) );
+    p = stop;
+  }
+  EXPECT_EQ (5004u, numbers.size () );
+}
+
+
+
+TEST_F (MatrixTextTest, parse_LargeTextInChunks_SameAsOneThread)
+{
+  // Arrange.
+  std::string text;
+  for (int i = 0; text.size () < 5 * MatrixText::MIN_CHUNK; ++i) {
+    text += std::to_string (i * 7919LL % 100003) + "." + std::to_string (i % 1000) + (i % 17 ? " " : ",\n");
+  }
+
+  // Act.
+  const std::vector <double> serial   = parse (text, 1);
+  const std::vector <double> parallel = parse (text, 4);
+
+  // Assert.
+  EXPECT_EQ (serial, parallel);
+}
+
+
+
+TEST_F (MatrixTextTest, parse_Word_Throws)
+{
+  // Act, Assert.
+  EXPECT_THROW (parse ("1 2 three 4"), std::runtime_error);
+  EXPECT_THROW (parse ("1e"), std::runtime_error);
+  EXPECT_TRUE (parse (" \n, ").empty () );
+}
+
+
+
+TEST_F (MatrixTextTest, parse_file_WrittenFile_NumbersBack)
+{
+  // Arrange.
+  std::ofstream file (path);
+  file << "2 2\n1.5 2\n3 4.25\n";
+  file.close ();
+
+  // Act.
+  const std::vector <double> numbers = MatrixText::parse_file (path);
+
+  // Assert.
+  const std::vector <double> etalon {2.0, 2.0, 1.5, 2.0, 3.0, 4.25};
+  EXPECT_EQ (etalon, numbers);
+  EXPECT_THROW (MatrixText::read_file ("matrixtexttest.missing"), std::runtime_error);
+}
@@ -710,3 +710,337 @@ TEST_F (MunkresTest, solve_3x3_IsValide_Fail)
   // Assert.
   EXPECT_NE (etalon_matrix, test_matrix);
 }
+
+
+
+// Reduced costs (a zero in every row and column, so the initial reduction
+// subtracts nothing) in tenths: the additions and subtractions of h in
+// step 5 leave residues around 1e-17 where exact arithmetic gives zeros.
+// Solved exactly, the residues cost two more passes through step 3 than
+// the 6 the integer costs take.
+static Matrix<double> residueMatrix (const double unit)
+{
+  const int tenths [5][5] = {
+    { 9,  0,  4,  7, 26},
+    {11,  2,  0, 19,  0},
+    {15,  1, 21,  0, 25},
+    {19, 22,  8,  0, 18},
+    { 0,  6,  5, 20, 16}
+  };
+  Matrix<double> matrix(5, 5);
+  for ( unsigned int row = 0 ; row < matrix.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < matrix.columns() ; col++ )
+      matrix(row,col) = tenths[row][col] * unit;
+  return matrix;
+}
+
+
+
+TEST_F (MunkresTest, solve_5x5_Step5Residues_NeedExtraPasses)
+{
+  // Arrange.
+  Matrix<double> integer_matrix = residueMatrix(1.0);
+  Matrix<double> test_matrix = residueMatrix(0.1);
+  Munkres<double> integer_munkres, munkres;
+  integer_munkres.set_iteration_limit(6);
+  munkres.set_iteration_limit(6);
+
+  // Act.
+  integer_munkres.solve(integer_matrix);
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_TRUE (integer_munkres.is_optimal() );
+  EXPECT_FALSE (munkres.is_optimal() );
+}
+
+
+
+TEST_F (MunkresTest, solve_5x5_AbsoluteTolerance_ResiduesAreZeros)
+{
+  // Arrange.
+  Matrix<double> etalon_matrix = residueMatrix(1.0);
+  Matrix<double> test_matrix = residueMatrix(0.1);
+  Munkres<double> exact;
+  exact.solve(etalon_matrix);
+  Munkres<double> munkres;
+  munkres.set_tolerance(1e-9);
+  munkres.set_iteration_limit(6);
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_TRUE (munkres.is_optimal() );
+  EXPECT_EQ (etalon_matrix, test_matrix);
+}
+
+
+
+TEST_F (MunkresTest, solve_5x5_RelativeTolerance_ScalesWithCosts)
+{
+  // Arrange.
+  Matrix<double> etalon_matrix = residueMatrix(1.0);
+  Matrix<double> absolute_matrix = residueMatrix(1e6 / 3);
+  Matrix<double> test_matrix = residueMatrix(1e6 / 3);
+  Munkres<double> exact;
+  exact.solve(etalon_matrix);
+  Munkres<double> absolute, munkres;
+  absolute.set_tolerance(1e-12);
+  absolute.set_iteration_limit(6);
+  munkres.set_tolerance(1e-12, true);
+  munkres.set_iteration_limit(6);
+
+  // Act.
+  absolute.solve(absolute_matrix);
+  munkres.solve(test_matrix);
+
+  // Assert.
+  // Residues of costs near 1e6 are around 1e-10: out of reach of an
+  // absolute 1e-12, within 1e-12 of the largest cost.
+  EXPECT_FALSE (absolute.is_optimal() );
+  EXPECT_TRUE (munkres.is_optimal() );
+  EXPECT_EQ (etalon_matrix, test_matrix);
+}
+
+
+
+TEST_F (MunkresTest, solve_5x5_IntegerRescale_ExactArithmetic)
+{
+  // Arrange.
+  Matrix<double> etalon_matrix = residueMatrix(1.0);
+  Matrix<double> test_matrix = residueMatrix(0.1);
+  Munkres<double> exact;
+  exact.solve(etalon_matrix);
+  Munkres<double> munkres;
+  munkres.set_integer_rescale(10);
+  munkres.set_iteration_limit(6);
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_TRUE (munkres.is_optimal() );
+  EXPECT_EQ (etalon_matrix, test_matrix);
+  EXPECT_DOUBLE_EQ (0.5, munkres.lower_bound() );
+}
+
+
+
+TEST_F (MunkresTest, solve_100x100_Tolerance_FindsExactOptimum)
+{
+  // Arrange.
+  // Integer costs below 2^31 are solved exactly in doubles. Scaled down,
+  // they differ by at least 1 / 3e9, far more than the 100 tolerances
+  // of about 7e-13 the assignment may lose: it must stay optimal.
+  Matrix<double> etalon_matrix = generateRandomMatrix(100, 100);
+  Matrix<double> matrix = etalon_matrix;
+  for ( unsigned int row = 0 ; row < matrix.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < matrix.columns() ; col++ )
+      matrix(row,col) /= 3e9;
+  Matrix<double> costs = etalon_matrix;
+  Munkres<double> exact;
+  exact.solve(etalon_matrix);
+  Munkres<double> munkres;
+  munkres.set_tolerance(1e-12, true);
+
+  // Act.
+  munkres.solve(matrix);
+
+  // Assert.
+  isSingleSolution(matrix);
+  double etalon_cost = 0, cost = 0;
+  for ( unsigned int row = 0 ; row < matrix.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < matrix.columns() ; col++ ) {
+      etalon_cost += etalon_matrix(row,col) == 0 ? costs(row,col) : 0;
+      cost += matrix(row,col) == 0 ? costs(row,col) : 0;
+    }
+  EXPECT_EQ (etalon_cost, cost);
+}
+
+
+
+TEST_F (MunkresTest, replace_infinites_3x3IntegerSentinel_Success)
+{
+  // Arrange.
+  const int infinity = Munkres<int>::infinity();
+  Matrix<int> etalon_matrix{
+    { 1,  8,  3},
+    { 8, -2,  7},
+    { 5,  8,  8}
+  };
+  Matrix<int> test_matrix{
+    { 1,        infinity, 3},
+    { infinity, -2,       7},
+    { 5,        infinity, infinity}
+  };
+
+  // Act.
+  Munkres<int>::replace_infinites(test_matrix);
+
+  // Assert.
+  EXPECT_EQ (std::numeric_limits<int>::max(), infinity);
+  EXPECT_EQ (etalon_matrix, test_matrix);
+}
+
+
+
+TEST_F (MunkresTest, solve_50x50_IntegerMatchesDouble_Success)
+{
+  // Arrange.
+  Matrix<double> double_matrix = generateRandomMatrix(50, 50);
+  Matrix<int> int_matrix(50, 50);
+  for ( unsigned int row = 0 ; row < double_matrix.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < double_matrix.columns() ; col++ ) {
+      double_matrix(row,col) = static_cast<int>(double_matrix(row,col)) % 1000;
+      int_matrix(row,col) = static_cast<int>(double_matrix(row,col));
+    }
+  const Matrix<double> costs = double_matrix;
+  Munkres<double> double_munkres;
+  Munkres<int> int_munkres;
+
+  // Act.
+  double_munkres.solve(double_matrix);
+  int_munkres.solve(int_matrix);
+
+  // Assert.
+  double double_cost = 0, int_cost = 0;
+  for ( unsigned int row = 0 ; row < costs.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < costs.columns() ; col++ ) {
+      if ( double_matrix(row,col) == 0 )
+        double_cost += costs(row,col);
+      if ( int_matrix(row,col) == 0 )
+        int_cost += costs(row,col);
+    }
+  EXPECT_EQ (double_cost, int_cost);
+}
+
+
+
+TEST_F (MunkresTest, solve_3x3_IntegerOverflow_Fail)
+{
+  // Arrange.
+  const int big = std::numeric_limits<int>::max() - 1;
+  Matrix<int> test_matrix{
+    {1,    big,  big},
+    {0,    3,    big},
+    {big,  0,    0}
+  };
+
+  Munkres<int> munkres;
+
+  // Act, Assert.
+  EXPECT_THROW (munkres.solve(test_matrix), std::overflow_error);
+}
+
+
+
+TEST_F (MunkresTest, solve_3x3_Integer64NoOverflow_Success)
+{
+  // Arrange.
+  const long long big = std::numeric_limits<int>::max() - 1;
+  Matrix<long long> etalon_matrix{
+    { 0, -1, -1},
+    {-1,  0, -1},
+    {-1, -1,  0}
+  };
+  Matrix<long long> test_matrix{
+    {1,    big,  big},
+    {0,    3,    big},
+    {big,  0,    0}
+  };
+
+  Munkres<long long> munkres;
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_EQ (etalon_matrix, test_matrix);
+}
+
+
+
+TEST_F (MunkresTest, solve_60x60_IterationLimit_IsSingleSolution_Success)
+{
+  // Arrange.
+  const Matrix<double> costs = generateRandomMatrix(60, 60);
+  Matrix<double> etalon_matrix = costs;
+  Matrix<double> test_matrix = costs;
+  Munkres<double> munkres;
+  munkres.solve(etalon_matrix);
+  const double optimum = munkres.lower_bound();
+  munkres.set_iteration_limit(5);
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_FALSE (munkres.is_optimal() );
+  isValidOutput (test_matrix);
+  isSingleSolution (test_matrix);
+  double cost = 0, etalon_cost = 0;
+  for ( unsigned int row = 0 ; row < costs.rows() ; row++ ) {
+    for ( unsigned int col = 0 ; col < costs.columns() ; col++ ) {
+      cost += test_matrix(row, col) == 0 ? costs(row, col) : 0;
+      etalon_cost += etalon_matrix(row, col) == 0 ? costs(row, col) : 0;
+    }
+  }
+  EXPECT_DOUBLE_EQ (etalon_cost, optimum);
+  EXPECT_GE (cost, optimum);
+  EXPECT_LE (munkres.lower_bound(), optimum);
+}
+
+
+
+TEST_F (MunkresTest, solve_200x200_TimeLimitExpired_IsSingleSolution_Success)
+{
+  // Arrange.
+  // At 200x200 the clock is read on every pass through step 3, so a
+  // 1 ns budget is spent at the first one; the stars of step 1 rarely
+  // cover a random matrix of this size.
+  const Matrix<double> costs = generateRandomMatrix(200, 200);
+  Matrix<double> etalon_matrix = costs;
+  Matrix<double> test_matrix = costs;
+  Munkres<double> munkres;
+  munkres.solve(etalon_matrix);
+  const double optimum = munkres.lower_bound();
+  munkres.set_time_limit(std::chrono::nanoseconds(1) );
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_FALSE (munkres.is_optimal() );
+  isValidOutput (test_matrix);
+  isSingleSolution (test_matrix);
+  double cost = 0;
+  for ( unsigned int row = 0 ; row < costs.rows() ; row++ )
+    for ( unsigned int col = 0 ; col < costs.columns() ; col++ )
+      cost += test_matrix(row, col) == 0 ? costs(row, col) : 0;
+  EXPECT_GE (cost, optimum);
+  EXPECT_LE (munkres.lower_bound(), cost);
+  EXPECT_LE (munkres.lower_bound(), optimum);
+}
+
+
+
+TEST_F (MunkresTest, solve_3x5_LowerBoundIsOptimum_Success)
+{
+  // Arrange.
+  Matrix<double> test_matrix{
+    {4.0, 1.0, 3.0, 9.0, 7.0},
+    {2.0, 0.0, 5.0, 8.0, 6.0},
+    {3.0, 2.0, 2.0, 7.0, 1.0}
+  };
+
+  Munkres<double> munkres;
+  munkres.set_time_limit(std::chrono::hours(1) );
+
+  // Act.
+  munkres.solve(test_matrix);
+
+  // Assert.
+  EXPECT_TRUE (munkres.is_optimal() );
+  EXPECT_DOUBLE_EQ (4.0, munkres.lower_bound() );
+}
@@ -0,0 +1,62 @@
+#include "ap_int.h"
+#include "cost_type.h"
+#include "munkres_steps.h"
+
+// Largest matrix and most problems per launch; see batch_plan.h.
+#define BATCH_MAX_SIZE 32
+#define BATCH_CAPACITY 256
+
+extern "C" {
+
+// Solves count small problems in one launch, one after the other in
+// local memory. Problem p is the reduced sizes[p] x sizes[p] matrix
+// starting at matrices[offsets[p]], rows back to back; its stars (step 1
+// on entry, the assignment on return, as for munkres_iteration_kernel)
+// are stars[p * BATCH_MAX_SIZE] onwards.
+void munkres_batch_kernel(
+    const cost_t *matrices,
+    const ap_uint<32> *sizes,
+    const ap_uint<32> *offsets,
+    int *stars,
+    ap_uint<32> count
+) {
+#pragma HLS INTERFACE m_axi port = matrices offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = sizes offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = offsets offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = stars offset = slave bundle = gmem
+#pragma HLS INTERFACE s_axilite port = count bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    cost_t local[BATCH_MAX_SIZE][BATCH_MAX_SIZE];
+    int star_col[BATCH_MAX_SIZE];
+
+    problem_loop: for (ap_uint<32> p = 0; p < count; p++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = BATCH_CAPACITY
+        const ap_uint<32> size = sizes[p];
+        const ap_uint<32> offset = offsets[p];
+
+        load_rows: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = BATCH_MAX_SIZE
+            load_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = BATCH_MAX_SIZE
+                local[row][col] = matrices[offset + row * size + col];
+            }
+        }
+        load_stars: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = BATCH_MAX_SIZE
+            star_col[row] = stars[p * BATCH_MAX_SIZE + row];
+        }
+
+        munkres_steps<BATCH_MAX_SIZE>(local, star_col, size);
+
+        store_stars: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = BATCH_MAX_SIZE
+            stars[p * BATCH_MAX_SIZE + row] = star_col[row];
+        }
+    }
+}
+
+}
@@ -0,0 +1,116 @@
+// C simulation testbench: bins a mix of problems with plan_batches, packs
+// every batch, runs munkres_batch_kernel on it and requires the gathered
+// solutions to match the CPU reference, each at its own index. The
+// costs are small integers, exact in every COST_TYPE.
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ap_int.h"
+#include "batch_plan.h"
+#include "cost_type.h"
+#include "cpu_backend.h"
+#include "munkres_context.h"
+
+extern "C" {
+void munkres_batch_kernel(const cost_t *matrices, const ap_uint<32> *sizes, const ap_uint<32> *offsets, int *stars,
+                          ap_uint<32> count);
+}
+
+// The kernel's view of a packed device_cost_t; differs only for ap_fixed,
+// packed as its raw bits.
+static cost_t to_cost(device_cost_t raw) {
+#if COST_TYPE == COST_FIXED
+    return cost_t(std::ldexp(static_cast<double>(raw), -(COST_FIXED_W - COST_FIXED_I)));
+#else
+    return raw;
+#endif
+}
+
+int main() {
+    std::mt19937 generator(38);
+    std::uniform_int_distribution<int> random_size(1, 40);
+    std::uniform_int_distribution<int> value(0, 99);
+
+    // 1500 problems: enough for more than one batch per bin, and some too
+    // large for the batch kernel.
+    std::vector<AssignmentProblem> problems(1500);
+    for (AssignmentProblem &problem : problems) {
+        problem.rows = random_size(generator);
+        problem.columns = (value(generator) < 80) ? problem.rows : random_size(generator);
+        problem.costs.resize(problem.rows * problem.columns);
+        for (double &cost : problem.costs) {
+            cost = value(generator);
+        }
+    }
+
+    std::vector<size_t> large;
+    const std::vector<Batch> batches = plan_batches(problems, large);
+
+    std::vector<device_cost_t> packed(BATCH_CAPACITY * BATCH_MAX_SIZE * BATCH_MAX_SIZE);
+    std::vector<cost_t> matrices(packed.size());
+    std::vector<uint32_t> sizes(BATCH_CAPACITY), offsets(BATCH_CAPACITY);
+    std::vector<ap_uint<32>> kernel_sizes(BATCH_CAPACITY), kernel_offsets(BATCH_CAPACITY);
+    std::vector<int> stars(BATCH_CAPACITY * BATCH_MAX_SIZE);
+
+    BatchPacker packer;
+    std::vector<std::vector<double>> solutions(problems.size());
+    size_t batched = 0;
+    bool valid = true;
+    for (const Batch &batch : batches) {
+        if (batch.empty() || batch.size() > BATCH_CAPACITY) {
+            std::cerr << "Batch of " << batch.size() << " problems" << std::endl;
+            valid = false;
+            continue;
+        }
+        packer.pack(problems, batch, packed.data(), sizes.data(), offsets.data(), stars.data());
+        const size_t used = offsets[batch.size() - 1] + sizes[batch.size() - 1] * sizes[batch.size() - 1];
+        for (size_t i = 0; i < used; i++) {
+            matrices[i] = to_cost(packed[i]);
+        }
+        for (size_t p = 0; p < batch.size(); p++) {
+            kernel_sizes[p] = sizes[p];
+            kernel_offsets[p] = offsets[p];
+        }
+        munkres_batch_kernel(matrices.data(), kernel_sizes.data(), kernel_offsets.data(), stars.data(), batch.size());
+        BatchPacker::unpack(problems, batch, stars.data(), solutions);
+        batched += batch.size();
+    }
+
+    MunkresContext reference(std::unique_ptr<SolverBackend>(new CpuBackend()));
+    size_t mismatches = 0, unsolved = 0;
+    for (size_t i = 0; i < problems.size(); i++) {
+        const AssignmentProblem &problem = problems[i];
+        const bool fits = std::max(problem.rows, problem.columns) <= BATCH_MAX_SIZE;
+        if (!fits) {
+            continue;
+        }
+        if (solutions[i].empty()) {
+            unsolved++;
+            continue;
+        }
+        std::vector<double> expected = problem.costs;
+        reference.solve(expected.data(), problem.rows, problem.columns);
+        if (solutions[i] != expected) {
+            std::cerr << "Problem " << i << " (" << problem.rows << "x" << problem.columns
+                      << ") differs from the CPU reference" << std::endl;
+            mismatches++;
+        }
+    }
+    for (size_t i : large) {
+        if (std::max(problems[i].rows, problems[i].columns) <= BATCH_MAX_SIZE) {
+            std::cerr << "Problem " << i << " fits the batch kernel but was left out" << std::endl;
+            valid = false;
+        }
+    }
+    valid = valid && mismatches == 0 && unsolved == 0 && batched + large.size() == problems.size();
+
+    std::cout << problems.size() << " problems: " << batched << " in " << batches.size() << " batches, "
+              << large.size() << " too large, " << mismatches << " mismatches, " << unsolved << " unsolved" << std::endl;
+    std::cout << "Cost type: " << COST_NAME << std::endl;
+    std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
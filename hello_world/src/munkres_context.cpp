@@ -0,0 +1,216 @@
+#include "munkres_context.h"
+#include "timeline.h"
+
+#include <algorithm>
+#include <utility>
+
+MunkresContext::MunkresContext(std::unique_ptr<SolverBackend> backend)
+    : m_backend(std::move(backend)), m_state(m_backend->state()) {
+}
+
+int MunkresContext::step1() {
+    for (size_t row = 0; row < m_state.size; row++) {
+        bool found_star = false;
+        for (size_t col = 0; col < m_state.size && !found_star; col++) {
+            if (m_state.matrix[row][col] == 0) {
+                bool has_star = false;
+                for (size_t nrow = 0; nrow < row && !has_star; nrow++) {
+                    if (mask(nrow, col) == STAR) {
+                        has_star = true;
+                    }
+                }
+                if (!has_star) {
+                    mask(row, col) = STAR;
+                    found_star = true;
+                }
+            }
+        }
+    }
+    return 2;
+}
+
+int MunkresContext::step2() {
+    size_t covercount = 0;
+    for (size_t row = 0; row < m_state.size; row++) {
+        for (size_t col = 0; col < m_state.size; col++) {
+            if (mask(row, col) == STAR) {
+                m_state.col_mask[col] = true;
+                covercount++;
+            }
+        }
+    }
+
+    if (covercount >= m_state.size) {
+        return 0;
+    }
+    return 3;
+}
+
+int MunkresContext::step3() {
+    if (m_backend->find_uncovered_zero(m_saverow, m_savecol)) {
+        mask(m_saverow, m_savecol) = PRIME;
+    } else {
+        return 5;
+    }
+
+    for (size_t ncol = 0; ncol < m_state.size; ncol++) {
+        if (mask(m_saverow, ncol) == STAR) {
+            m_state.row_mask[m_saverow] = true;
+            m_state.col_mask[ncol] = false;
+            return 3;
+        }
+    }
+
+    return 4;
+}
+
+int MunkresContext::step4() {
+    // Alternating sequence: the prime from step 3, the star in its
+    // column, the prime in that star's row, and so on until a column
+    // without a star.
+    std::vector<std::pair<size_t, size_t>> seq;
+    seq.push_back(std::make_pair(m_saverow, m_savecol));
+
+    size_t col = m_savecol;
+    for (;;) {
+        size_t row = 0;
+        while (row < m_state.size && mask(row, col) != STAR) {
+            row++;
+        }
+        if (row == m_state.size) {
+            break;
+        }
+        seq.push_back(std::make_pair(row, col));
+
+        // Every row covered in step 3 holds a prime.
+        col = 0;
+        while (mask(row, col) != PRIME) {
+            col++;
+        }
+        seq.push_back(std::make_pair(row, col));
+    }
+
+    // Unstar the stars and star the primes of the sequence
+    for (size_t i = 0; i < seq.size(); i++) {
+        int &value = mask(seq[i].first, seq[i].second);
+        value = (value == STAR) ? NORMAL : STAR;
+    }
+
+    // Clear primes and reset masks
+    for (size_t i = 0; i < m_state.size; i++) {
+        for (size_t j = 0; j < m_state.size; j++) {
+            if (mask(i, j) == PRIME) {
+                mask(i, j) = NORMAL;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_state.size; i++) {
+        m_state.row_mask[i] = false;
+        m_state.col_mask[i] = false;
+    }
+
+    return 2;
+}
+
+int MunkresContext::step5() {
+    m_backend->step5();
+    return 3;
+}
+
+void MunkresContext::stars_from_mask(int *stars) {
+    for (size_t row = 0; row < m_state.size; row++) {
+        stars[row] = -1;
+        for (size_t col = 0; col < m_state.size; col++) {
+            if (mask(row, col) == STAR) {
+                stars[row] = static_cast<int>(col);
+            }
+        }
+    }
+}
+
+void MunkresContext::prepare(const double *matrix, size_t rows, size_t columns, int *stars) {
+    TimelineScope scope("prepare");
+    const size_t size = std::max(rows, columns);
+    m_backend->resize(size);
+    m_mask_matrix.resize(size * size);
+
+    // Copy input matrix to the working matrix, padding a non square input
+    // with its largest value.
+    double largest = matrix[0];
+    for (size_t i = 0; i < rows * columns; i++) {
+        largest = std::max(largest, matrix[i]);
+    }
+    for (size_t i = 0; i < m_state.size; i++) {
+        for (size_t j = 0; j < m_state.size; j++) {
+            m_state.matrix[i][j] = (i < rows && j < columns) ? matrix[i * columns + j] : largest;
+            mask(i, j) = NORMAL;
+        }
+    }
+
+    // Prepare matrix values and star the zeros, on the device if the
+    // backend can.
+    if (m_backend->reduce_and_star(rows < columns, stars)) {
+        for (size_t row = 0; row < m_state.size; row++) {
+            if (stars[row] >= 0) {
+                mask(row, stars[row]) = STAR;
+            }
+        }
+        return;
+    }
+    m_backend->reduce(rows < columns);
+
+    step1();
+    stars_from_mask(stars);
+}
+
+void MunkresContext::finish(const int *stars, double *matrix, size_t rows, size_t columns) {
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < columns; col++) {
+            matrix[row * columns + col] = (stars[row] == static_cast<int>(col)) ? 0 : -1;
+        }
+    }
+}
+
+void MunkresContext::solve(double *matrix, size_t rows, size_t columns) {
+    solve(matrix, rows, columns, matrix);
+}
+
+void MunkresContext::solve(const double *costs, size_t rows, size_t columns, double *solution) {
+    TimelineScope solve_scope("solve");
+    m_stars.resize(std::max(rows, columns));
+    prepare(costs, rows, columns, m_stars.data());
+
+    // Follow the steps, unless the backend runs steps 2 to 5 itself
+    bool device_iteration;
+    {
+        TimelineScope scope("solve_from_stars");
+        device_iteration = m_backend->solve_from_stars(m_stars.data());
+    }
+    if (!device_iteration) {
+        static const char *const step_names[] = {"", "", "step2", "step3", "step4", "step5"};
+        int step = 2;
+        while (step) {
+            TimelineScope scope(step_names[step]);
+            switch (step) {
+                case 2:
+                    step = step2();
+                    break;
+                case 3:
+                    step = step3();
+                    break;
+                case 4:
+                    step = step4();
+                    break;
+                case 5:
+                    step = step5();
+                    break;
+            }
+        }
+        stars_from_mask(m_stars.data());
+    }
+
+    // Store results back to input matrix
+    TimelineScope scope("finish");
+    finish(m_stars.data(), solution, rows, columns);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "solver_backend.h"
+
+#include <memory>
+#include <vector>
+
+// One assignment problem: rows x columns costs, row major.
+struct AssignmentProblem {
+    size_t rows = 0;
+    size_t columns = 0;
+    std::vector<double> costs;
+};
+
+// One solver: the step state of the Munkres loop plus the backend that
+// owns the host and device buffers. Contexts share nothing, so several
+// can solve at the same time on different threads, each with its own
+// backend (command queue and kernel instance for OpenCL).
+class MunkresContext {
+public:
+    explicit MunkresContext(std::unique_ptr<SolverBackend> backend);
+
+    // Replaces matrix (rows x columns, row major) with the assignment:
+    // 0 for assigned pairs, -1 elsewhere.
+    void solve(double *matrix, size_t rows, size_t columns);
+    // The same, reading the costs from costs (a mapped file, say) and
+    // writing the assignment to solution; the two may be the same.
+    void solve(const double *costs, size_t rows, size_t columns, double *solution);
+
+    // The two ends of solve() for drivers that run steps 2 to 5 on their
+    // own. prepare() pads and reduces the input and runs step 1, leaving
+    // the reduced matrix in backend().state() (unless the backend keeps
+    // it on the device, see SolverBackend::reduce_and_star()) and the
+    // starred column of each row (-1 for none) in stars; finish() writes
+    // the assignment given by stars to matrix the way solve() does.
+    void prepare(const double *matrix, size_t rows, size_t columns, int *stars);
+    static void finish(const int *stars, double *matrix, size_t rows, size_t columns);
+
+    SolverBackend &backend() { return *m_backend; }
+
+private:
+    int step1();
+    int step2();
+    int step3();
+    int step4();
+    int step5();
+    void stars_from_mask(int *stars);
+
+    int &mask(size_t row, size_t col) { return m_mask_matrix[row * m_state.size + col]; }
+
+    std::unique_ptr<SolverBackend> m_backend;
+    MunkresState &m_state;
+    std::vector<int> m_mask_matrix;
+    std::vector<int> m_stars;
+    size_t m_saverow = 0;
+    size_t m_savecol = 0;
+};
@@ -3,556 +3,584 @@
 #include <fstream>
 #include <string>
 #include <cstdlib>
-#include <cstdio>
-#include <sys/time.h>
-#include <sys/ioctl.h>
-#include <errno.h>
-#include <sstream>
-
-#include "CL/cl.h"
-#include "CL/cl_ext_xilinx.h"
-#include "xcl2.hpp"
-
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <cstdlib>
-#include <ctime>
-#include <vector>
 #include <cmath>
-#include <limits>
-
-constexpr int NORMAL = 0;
-constexpr int STAR   = 1;
-constexpr int PRIME  = 2;
-constexpr size_t MAX_SIZE = 256;
-
-// Add global variables after the existing constants
-double global_matrix[MAX_SIZE][MAX_SIZE];
-int global_mask_matrix[MAX_SIZE][MAX_SIZE];
-bool global_row_mask[MAX_SIZE];
-bool global_col_mask[MAX_SIZE];
-size_t global_size;
-size_t global_saverow;
-size_t global_savecol;
-double global_item;  
-
-// Function declarations
-void replace_infinites(void);
-void minimize_along_direction(bool over_columns);
-bool find_uncovered_in_matrix(size_t &row, size_t &col);  // Modified to remove item parameter
-int step1(void);
-int step2(void);
-int step3(void);
-int step4(void);
-int step5(void);
-
-// Function implementations
-void replace_infinites(void) {
-    double max = global_matrix[0][0];
-    constexpr auto infinity = std::numeric_limits<double>::infinity();
-
-    // Find the greatest value in the matrix that isn't infinity
-    for (size_t row = 0; row < global_size; row++) {
-        for (size_t col = 0; col < global_size; col++) {
-            if (global_matrix[row][col] != infinity) {
-                if (max == infinity) {
-                    max = global_matrix[row][col];
-                } else {
-                    max = std::max<double>(max, global_matrix[row][col]);
-                }
-            }
-        }
-    }
-
-    // A value higher than the maximum value present in the matrix
-    if (max == infinity) {
-        max = 0;
-    } else {
-        max++;
-    }
-
-    for (size_t row = 0; row < global_size; row++) {
-        for (size_t col = 0; col < global_size; col++) {
-            if (global_matrix[row][col] == infinity) {
-                global_matrix[row][col] = max;
-            }
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <thread>
+
+#include "cmdlineparser.h"
+#include "munkres_context.h"
+#include "cpu_backend.h"
+#include "shard_scheduler.h"
+#include "solver_service.h"
+#include "timeline.h"
+#ifndef MUNKRES_CPU_ONLY
+#include "opencl_backend.h"
+#include "stream_pipeline.h"
+#include "batch_dispatcher.h"
+#include "hybrid_backend.h"
+#endif
+#include "munkres.h"
+#include "matrixfile.h"
+#include "matrixtext.h"
+
+// Cost of the assignment in solution (0 for assigned pairs).
+double assignment_cost(const double *costs, const std::vector<double> &solution) {
+    double total = 0;
+    for (size_t i = 0; i < solution.size(); i++) {
+        if (solution[i] == 0) {
+            total += costs[i];
         }
     }
+    return total;
 }
 
-void minimize_along_direction(double matrix[][MAX_SIZE], size_t size, bool over_columns) {
-    for (size_t i = 0; i < size; i++) {
-        double min = over_columns ? matrix[0][i] : matrix[i][0];
-
-        for (size_t j = 1; j < size && min > 0; j++) {
-            min = std::min<double>(min, over_columns ? matrix[j][i] : matrix[i][j]);
+// Checks that every row and column is matched at most once, and exactly
+// once along the smaller dimension.
+bool check_assignment(const std::vector<double> &matrix, size_t rows, size_t columns) {
+    bool valid = true;
+    for (size_t row = 0; row < rows; row++) {
+        int rowcount = 0;
+        for (size_t col = 0; col < columns; col++) {
+            if (matrix[row * columns + col] == 0)
+                rowcount++;
         }
-
-        if (min > 0) {
-            for (size_t j = 0; j < size; j++) {
-                if (over_columns) {
-                    matrix[j][i] -= min;
-                } else {
-                    matrix[i][j] -= min;
-                }
-            }
+        // With more rows than columns, some rows stay unmatched.
+        if (rowcount > 1 || (rowcount == 0 && columns >= rows)) {
+            std::cerr << "Row " << row << " has " << rowcount << " columns that have been matched." << std::endl;
+            valid = false;
         }
     }
-}
 
-bool find_uncovered_in_matrix_hls(const double matrix[][MAX_SIZE], const int mask_matrix[][MAX_SIZE],
-                                const bool row_mask[], const bool col_mask[],
-                                const double item, size_t &row, size_t &col, size_t size,
-                                cl::Context& context, cl::CommandQueue& q, cl::Kernel& krnl_find_uncovered) {
-    try {
-        cl_int err;
-        
-        // Flatten 2D arrays for buffer creation with aligned allocator
-        std::vector<double, aligned_allocator<double>> flat_matrix(MAX_SIZE * MAX_SIZE);
-        std::vector<int, aligned_allocator<int>> flat_mask_matrix(MAX_SIZE * MAX_SIZE);
-        std::vector<bool, aligned_allocator<bool>> flat_row_mask(MAX_SIZE);
-        std::vector<bool, aligned_allocator<bool>> flat_col_mask(MAX_SIZE);
-        
-        for (size_t i = 0; i < MAX_SIZE; i++) {
-            for (size_t j = 0; j < MAX_SIZE; j++) {
-                flat_matrix[i * MAX_SIZE + j] = matrix[i][j];
-                flat_mask_matrix[i * MAX_SIZE + j] = mask_matrix[i][j];
-            }
-            flat_row_mask[i] = row_mask[i];
-            flat_col_mask[i] = col_mask[i];
+    for (size_t col = 0; col < columns; col++) {
+        int colcount = 0;
+        for (size_t row = 0; row < rows; row++) {
+            if (matrix[row * columns + col] == 0)
+                colcount++;
         }
-        
-        // Allocate memory on device with initial data
-        cl::Buffer matrix_buffer = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, 
-            sizeof(double)*MAX_SIZE*MAX_SIZE, flat_matrix.data());
-        cl::Buffer mask_matrix_buffer = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, 
-            sizeof(int)*MAX_SIZE*MAX_SIZE, flat_mask_matrix.data());
-        cl::Buffer row_mask_buffer = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, 
-            sizeof(bool)*MAX_SIZE, flat_row_mask.data());
-        cl::Buffer col_mask_buffer = cl::Buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, 
-            sizeof(bool)*MAX_SIZE, flat_col_mask.data());
-        cl::Buffer row_out_buffer = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(size_t), nullptr);
-        cl::Buffer col_out_buffer = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(size_t), nullptr);
-        cl::Buffer found_buffer = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(bool), nullptr);
-
-        // Set kernel arguments
-        OCL_CHECK(krnl_find_uncovered.setArg(0, matrix_buffer),
-                  "Failed to set matrix buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(1, mask_matrix_buffer),
-                  "Failed to set mask matrix buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(2, row_mask_buffer),
-                  "Failed to set row mask buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(3, col_mask_buffer),
-                  "Failed to set column mask buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(4, item),
-                  "Failed to set item argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(5, size),
-                  "Failed to set size argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(6, row_out_buffer),
-                  "Failed to set row output buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(7, col_out_buffer),
-                  "Failed to set column output buffer argument");
-        OCL_CHECK(krnl_find_uncovered.setArg(8, found_buffer),
-                  "Failed to set found buffer argument");
-
-        // Migrate input data to device
-        std::vector<cl::Memory> inBufVec;
-        inBufVec.push_back(matrix_buffer);
-        inBufVec.push_back(mask_matrix_buffer);
-        inBufVec.push_back(row_mask_buffer);
-        inBufVec.push_back(col_mask_buffer);
-        OCL_CHECK(q.enqueueMigrateMemObjects(inBufVec, 0 /* 0 means from host*/),
-                  "Failed to migrate input buffers to device");
-
-        // Launch kernel
-        cl::Event event;
-        OCL_CHECK(q.enqueueTask(krnl_find_uncovered, nullptr, &event),
-                  "Failed to launch kernel");
-
-        // Migrate output data to host
-        std::vector<cl::Memory> outBufVec;
-        outBufVec.push_back(found_buffer);
-        outBufVec.push_back(row_out_buffer);
-        outBufVec.push_back(col_out_buffer);
-        OCL_CHECK(q.enqueueMigrateMemObjects(outBufVec, CL_MIGRATE_MEM_OBJECT_HOST),
-                  "Failed to migrate output buffers to host");
-
-        // Wait for all operations to complete
-        OCL_CHECK(q.finish(),
-                  "Failed to finish command queue");
-
-        // Get kernel execution time
-        cl_ulong time_start, time_end;
-        event.getProfilingInfo(CL_PROFILING_COMMAND_START, &time_start);
-        event.getProfilingInfo(CL_PROFILING_COMMAND_END, &time_end);
-        double duration = (time_end - time_start) / 1000000.0; // Convert to milliseconds
-        std::cout << "Kernel execution time: " << duration << " ms" << std::endl;
-
-        // Get results from migrated buffers
-        bool found;
-        size_t row_out, col_out;
-        void* found_ptr = q.enqueueMapBuffer(found_buffer, CL_TRUE, CL_MAP_READ, 0, sizeof(bool), nullptr, nullptr, nullptr);
-        void* row_ptr = q.enqueueMapBuffer(row_out_buffer, CL_TRUE, CL_MAP_READ, 0, sizeof(size_t), nullptr, nullptr, nullptr);
-        void* col_ptr = q.enqueueMapBuffer(col_out_buffer, CL_TRUE, CL_MAP_READ, 0, sizeof(size_t), nullptr, nullptr, nullptr);
-        
-        found = *static_cast<bool*>(found_ptr);
-        row_out = *static_cast<size_t*>(row_ptr);
-        col_out = *static_cast<size_t*>(col_ptr);
-
-        // Unmap buffers
-        q.enqueueUnmapMemObject(found_buffer, found_ptr);
-        q.enqueueUnmapMemObject(row_out_buffer, row_ptr);
-        q.enqueueUnmapMemObject(col_out_buffer, col_ptr);
-
-        if (found) {
-            row = row_out;
-            col = col_out;
-            return true;
+        if (colcount > 1 || (colcount == 0 && rows >= columns)) {
+            std::cerr << "Column " << col << " has " << colcount << " rows that have been matched." << std::endl;
+            valid = false;
         }
-        return false;
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Error in find_uncovered_in_matrix_hls: " << e.what() << std::endl;
-        return false;
     }
+    return valid;
 }
 
-int step1(void) {
-    for (size_t row = 0; row < global_size; row++) {
-        bool found_star = false;
-        for (size_t col = 0; col < global_size && !found_star; col++) {
-            if (global_matrix[row][col] == 0) {
-                bool has_star = false;
-                for (size_t nrow = 0; nrow < row && !has_star; nrow++) {
-                    if (global_mask_matrix[nrow][col] == STAR) {
-                        has_star = true;
-                    }
-                }
-                if (!has_star) {
-                    global_mask_matrix[row][col] = STAR;
-                    found_star = true;
-                }
-            }
+// Splits the numbers of a text input into problems: rows, columns and
+// the costs of each, back to back.
+bool split_problems(const std::vector<double> &numbers, const std::string &name,
+                    std::vector<AssignmentProblem> &problems) {
+    size_t next = 0;
+    do {
+        if (numbers.size() - next < 2 || !(numbers[next] >= 1 && numbers[next + 1] >= 1)) {
+            std::cerr << "Bad matrix dimensions in " << name << std::endl;
+            return false;
         }
-    }
-    return 2;
-}
-
-int step2(void) {
-    size_t covercount = 0;
-    for (size_t row = 0; row < global_size; row++) {
-        for (size_t col = 0; col < global_size; col++) {
-            if (global_mask_matrix[row][col] == STAR) {
-                global_col_mask[col] = true;
-                covercount++;
-            }
+        AssignmentProblem problem;
+        problem.rows = numbers[next];
+        problem.columns = numbers[next + 1];
+        next += 2;
+        if (numbers[next - 2] * numbers[next - 1] > numbers.size() - next) {
+            std::cerr << "Expected " << problem.rows * problem.columns << " values in " << name << std::endl;
+            return false;
         }
-    }
-
-    if (covercount >= global_size) {
-        return 0;
-    }
-    return 3;
+        problem.costs.assign(numbers.begin() + next, numbers.begin() + next + problem.rows * problem.columns);
+        next += problem.costs.size();
+        problems.push_back(std::move(problem));
+    } while (next < numbers.size());
+    return true;
 }
 
-int step3(void) {
-    global_item = 0;  // Set the global item before calling find_uncovered_in_matrix
-    if (find_uncovered_in_matrix(global_saverow, global_savecol)) {
-        global_mask_matrix[global_saverow][global_savecol] = PRIME;
+// Copies matrix i of a mapped matrix file into problem.
+void read_mapped_problem(const MatrixFile &matrices, size_t i, AssignmentProblem &problem) {
+    problem.rows = matrices.rows(i);
+    problem.columns = matrices.columns(i);
+    const size_t size = problem.rows * problem.columns;
+    if (matrices.dtype() == MatrixFile::DOUBLE) {
+        const double *costs = matrices.data<double>(i);
+        problem.costs.assign(costs, costs + size);
     } else {
-        return 5;
+        const float *costs = matrices.data<float>(i);
+        problem.costs.assign(costs, costs + size);
     }
-
-    for (size_t ncol = 0; ncol < global_size; ncol++) {
-        if (global_mask_matrix[global_saverow][ncol] == STAR) {
-            global_row_mask[global_saverow] = true;
-            global_col_mask[ncol] = false;
-            return 3;
-        }
-    }
-
-    return 4;
 }
 
-int step4(void) {
-    // Find alternating sequence of starred and primed zeros
-    size_t row = global_saverow;
-    size_t col = global_savecol;
-    bool found_star = false;
-    bool found_prime = false;
-
-    // Find starred zero in column
-    for (size_t i = 0; i < global_size; i++) {
-        if (global_mask_matrix[i][col] == STAR) {
-            row = i;
-            found_star = true;
-            break;
+// Cost of the optimal assignment according to munkres-cpp.
+double reference_cost(const AssignmentProblem &problem) {
+    Matrix<double> reference(problem.rows, problem.columns);
+    for (size_t row = 0; row < problem.rows; row++) {
+        for (size_t col = 0; col < problem.columns; col++) {
+            reference(row, col) = problem.costs[row * problem.columns + col];
         }
     }
-
-    if (found_star) {
-        // Find primed zero in row
-        for (size_t j = 0; j < global_size; j++) {
-            if (global_mask_matrix[row][j] == PRIME) {
-                col = j;
-                found_prime = true;
-                break;
-            }
+    Munkres<double> munkres;
+    munkres.solve(reference);
+    std::vector<double> expected(problem.costs.size());
+    for (size_t row = 0; row < problem.rows; row++) {
+        for (size_t col = 0; col < problem.columns; col++) {
+            expected[row * problem.columns + col] = reference(row, col);
         }
     }
+    return assignment_cost(problem.costs.data(), expected);
+}
 
-    // Update masks
-    if (found_star && found_prime) {
-        global_mask_matrix[global_saverow][global_savecol] = STAR;
-        global_mask_matrix[row][col] = NORMAL;
-    }
-
-    // Clear primes and reset masks
-    for (size_t i = 0; i < global_size; i++) {
-        for (size_t j = 0; j < global_size; j++) {
-            if (global_mask_matrix[i][j] == PRIME) {
-                global_mask_matrix[i][j] = NORMAL;
+// Checks every solution is an assignment and, with verify, that its cost
+// is within the quantization error's bound of the optimum.
+bool check_solutions(const std::vector<AssignmentProblem> &problems, const std::vector<std::vector<double>> &solutions,
+                     double quantization_error, bool verify) {
+    bool valid = true;
+    double worst_loss = 0;
+    for (size_t i = 0; i < problems.size(); i++) {
+        const AssignmentProblem &problem = problems[i];
+        if (!check_assignment(solutions[i], problem.rows, problem.columns)) {
+            std::cerr << "Matrix " << i << " has an invalid assignment" << std::endl;
+            valid = false;
+        } else if (verify) {
+            const double loss = assignment_cost(problem.costs.data(), solutions[i]) - reference_cost(problem);
+            const double tolerance = 2 * std::max(problem.rows, problem.columns) * quantization_error;
+            if (std::fabs(loss) > tolerance) {
+                std::cerr << "Matrix " << i << " is " << loss << " off the optimum" << std::endl;
+                valid = false;
             }
+            worst_loss = std::max(worst_loss, loss);
         }
     }
-
-    for (size_t i = 0; i < global_size; i++) {
-        global_row_mask[i] = false;
-        global_col_mask[i] = false;
+    if (verify) {
+        std::cout << "Verified " << problems.size() << " matrices, largest precision loss: " << worst_loss << std::endl;
     }
-
-    return 2;
+    return valid;
 }
 
-int step5(void) {
-    double h = std::numeric_limits<double>::max();
-    
-    // Find minimum uncovered value
-    for (size_t row = 0; row < global_size; row++) {
-        if (!global_row_mask[row]) {
-            for (size_t col = 0; col < global_size; col++) {
-                if (!global_col_mask[col]) {
-                    if (h > global_matrix[row][col] && global_matrix[row][col] != 0) {
-                        h = global_matrix[row][col];
-                    }
-                }
+// Solves every matrix of the input in order: through the StreamPipeline
+// on the device, or one after the other on the CPU. With batch, the
+// matrices that fit munkres_batch_kernel are solved in batches spread
+// over cus compute units first, and only the others are streamed.
+// Matrices too large for munkres_iteration_kernel are solved per step.
+// With shard, the matrices are spread over every device instead (over
+// shards CPU contexts standing in for devices on the CPU), each with its
+// own queue, the idle ones stealing from the others.
+int run_stream(const std::vector<AssignmentProblem> &problems, const std::string &backend_name,
+               const std::string &xclbin, int depth, int cus, bool batch, bool shard, int shards, bool verify) {
+    std::vector<std::vector<double>> solutions(problems.size());
+    double quantization_error = 0;
+    if (shard) {
+#ifndef MUNKRES_CPU_ONLY
+        std::vector<std::unique_ptr<OpenClDevice>> devices;
+#endif
+        std::vector<std::unique_ptr<MunkresContext>> contexts;
+        if (backend_name == "cpu") {
+            for (int i = 0; i < shards; i++) {
+                contexts.emplace_back(new MunkresContext(std::unique_ptr<SolverBackend>(new CpuBackend())));
             }
+#ifndef MUNKRES_CPU_ONLY
+        } else if (backend_name == "opencl") {
+            devices = OpenClDevice::open_all(xclbin);
+            for (auto &device : devices) {
+                contexts.emplace_back(new MunkresContext(std::unique_ptr<SolverBackend>(new OpenClBackend(*device))));
+            }
+#endif
+        } else {
+            std::cerr << "Unknown or unavailable backend: " << backend_name << std::endl;
+            return EXIT_FAILURE;
         }
-    }
-
-    // Add h to covered rows
-    for (size_t row = 0; row < global_size; row++) {
-        if (global_row_mask[row]) {
-            for (size_t col = 0; col < global_size; col++) {
-                global_matrix[row][col] += h;
+        ShardScheduler scheduler(std::move(contexts));
+        scheduler.solve(problems, solutions);
+        scheduler.report(std::cout);
+        quantization_error = scheduler.quantization_error();
+    } else if (backend_name == "cpu") {
+        MunkresContext context(std::unique_ptr<SolverBackend>(new CpuBackend()));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < problems.size(); i++) {
+            solutions[i] = problems[i].costs;
+            context.solve(solutions[i].data(), problems[i].rows, problems[i].columns);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Stream: " << problems.size() << " matrices on the CPU, "
+                  << problems.size() / seconds << " matrices/s sustained" << std::endl;
+#ifndef MUNKRES_CPU_ONLY
+    } else if (backend_name == "opencl") {
+        OpenClDevice device(xclbin);
+        std::vector<size_t> rest;
+        if (batch) {
+            BatchDispatcher dispatcher(device, std::max(cus, 1));
+            dispatcher.solve(problems, solutions, rest);
+            dispatcher.report(std::cout);
+            quantization_error = dispatcher.quantization_error();
+        } else {
+            for (size_t i = 0; i < problems.size(); i++) {
+                rest.push_back(i);
             }
         }
-    }
 
-    // Subtract h from uncovered columns
-    for (size_t col = 0; col < global_size; col++) {
-        if (!global_col_mask[col]) {
-            for (size_t row = 0; row < global_size; row++) {
-                global_matrix[row][col] -= h;
+        // Pipeline what fits munkres_iteration_kernel; search the larger
+        // matrices per step, one at a time.
+        std::vector<AssignmentProblem> streamed;
+        std::vector<size_t> streamed_index, large;
+        for (size_t i : rest) {
+            if (std::max(problems[i].rows, problems[i].columns) <= ITERATION_MAX_SIZE) {
+                streamed.push_back(problems[i]);
+                streamed_index.push_back(i);
+            } else {
+                large.push_back(i);
+            }
+        }
+        if (!streamed.empty()) {
+            std::vector<std::vector<double>> streamed_solutions;
+            StreamPipeline pipeline(device, depth, cus > 0 ? 0 : -1);
+            pipeline.solve(streamed, streamed_solutions);
+            pipeline.report(std::cout);
+            for (size_t k = 0; k < streamed.size(); k++) {
+                solutions[streamed_index[k]] = std::move(streamed_solutions[k]);
             }
+            quantization_error = std::max(quantization_error, pipeline.quantization_error());
         }
+        if (!large.empty()) {
+            MunkresContext context(std::unique_ptr<SolverBackend>(new OpenClBackend(device, cus > 0 ? 0 : -1)));
+            for (size_t i : large) {
+                solutions[i] = problems[i].costs;
+                context.solve(solutions[i].data(), problems[i].rows, problems[i].columns);
+            }
+            std::cout << "Searched " << large.size() << " matrices larger than " << ITERATION_MAX_SIZE
+                      << " per step" << std::endl;
+            context.backend().report(std::cout);
+            quantization_error = std::max(quantization_error, context.backend().quantization_error());
+        }
+#endif
+    } else {
+        std::cerr << "Unknown or unavailable backend: " << backend_name << std::endl;
+        return EXIT_FAILURE;
     }
 
-    return 3;
+    const bool valid = check_solutions(problems, solutions, quantization_error, verify);
+    std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-void solve_munkres(double* matrix, size_t rows, size_t columns) {
-    global_size = std::max(rows, columns);
-    
-    // Copy input matrix to global matrix
-    for (size_t i = 0; i < rows; i++) {
-        for (size_t j = 0; j < columns; j++) {
-            global_matrix[i][j] = matrix[i * columns + j];
-        }
+// Solves every matrix of the input on the SolverService at path, one
+// request after the other, and stops the service afterwards with stop.
+int run_client(const std::vector<AssignmentProblem> &problems, const std::string &path, bool stop, bool verify) {
+    std::vector<std::vector<double>> solutions(problems.size());
+    std::vector<double> request_ms;
+    double quantization_error = 0;
+    auto start = std::chrono::steady_clock::now();
+    SolverClient client(path);
+    const double connect_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (size_t i = 0; i < problems.size(); i++) {
+        auto sent = std::chrono::steady_clock::now();
+        quantization_error = std::max(quantization_error, client.solve(problems[i], solutions[i]));
+        request_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sent).count());
     }
-
-    // Initialize masks
-    for (size_t i = 0; i < global_size; i++) {
-        global_row_mask[i] = false;
-        global_col_mask[i] = false;
+    if (stop) {
+        client.stop();
     }
+    std::cout << "Client: connected in " << connect_ms << " ms" << std::endl;
+    log_latencies(std::cout, "Client, round trip", request_ms);
 
-    // Prepare matrix values
-    replace_infinites();
-    minimize_along_direction(rows >= columns);
-    minimize_along_direction(rows < columns);
+    const bool valid = check_solutions(problems, solutions, quantization_error, verify);
+    std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    // Follow the steps
-    int step = 1;
-    while (step) {
-        switch (step) {
-            case 1:
-                step = step1();
-                break;
-            case 2:
-                step = step2();
-                break;
-            case 3:
-                step = step3();
-                break;
-            case 4:
-                step = step4();
-                break;
-            case 5:
-                step = step5();
-                break;
-        }
+// Owns the timeline while tracing and writes it to path when main
+// returns, whichever way it returns.
+class TraceFile {
+public:
+    explicit TraceFile(const std::string &path) : m_path(path) { set_timeline(&m_timeline); }
+    ~TraceFile() {
+        set_timeline(nullptr);
+        std::ofstream out(m_path);
+        m_timeline.write_chrome_trace(out);
+        m_timeline.summarize(std::cout);
+        std::cout << "Trace written to " << m_path << std::endl;
     }
 
-    // Store results back to input matrix
-    for (size_t row = 0; row < rows; row++) {
-        for (size_t col = 0; col < columns; col++) {
-            if (global_mask_matrix[row][col] == STAR) {
-                matrix[row * columns + col] = 0;
-            } else {
-                matrix[row * columns + col] = -1;
-            }
+private:
+    std::string m_path;
+    Timeline m_timeline;
+};
+
+int main(int argc, char *argv[]) {
+    const auto started = std::chrono::steady_clock::now();
+    sda::utils::CmdLineParser parser;
+    parser.addSwitch("--input", "-i", "cost matrix file: rows, columns, then the values");
+    parser.addSwitch("--xclbin", "-x", "xclbin holding find_uncovered_kernel");
+    parser.addSwitch("--backend", "-b", "cpu, opencl or hybrid (default: opencl if --xclbin is given)");
+    parser.addSwitch("--repeat", "-r", "number of timed solves", "1");
+    parser.addSwitch("--contexts", "-c", "number of solver contexts, each solving on its own thread", "1");
+    parser.addSwitch("--cus", "-u", "compute units to spread the contexts over (0: let the runtime pick)", "0");
+    parser.addSwitch("--per-step", "-p", "launch find_uncovered_kernel per prime instead of munkres_iteration_kernel", "", true);
+    parser.addSwitch("--auction", "-n", "solve matrices up to 256x256 with auction_kernel instead of the Hungarian steps", "", true);
+    parser.addSwitch("--stream", "-s", "solve every matrix of the input, pipelined on the device", "", true);
+    parser.addSwitch("--depth", "-d", "matrices in flight when streaming", "2");
+    parser.addSwitch("--batch", "-a", "when streaming, solve matrices up to 32x32 in batches on --cus compute units", "", true);
+    parser.addSwitch("--shard", "-g", "when streaming, spread the matrices over every device with work stealing "
+                     "(cpu: over --contexts stand-in devices)", "", true);
+    parser.addSwitch("--serve", "-e", "run as a solver service on this Unix socket, the device programmed once");
+    parser.addSwitch("--connect", "-o", "solve every matrix of the input on the solver service at this Unix socket");
+    parser.addSwitch("--stop-service", "-q", "with --connect, stop the service afterwards", "", true);
+    parser.addSwitch("--verify", "-v", "check the cost against the munkres-cpp solver", "", true);
+    parser.addSwitch("--trace", "-t", "write a Chrome trace of the host steps and device commands to this file");
+    const int options = parser.parse(argc, argv);
+    if (options < 0 || (parser.value("input").empty() && parser.value("serve").empty())) {
+        if (options >= 0) {
+            parser.printHelp();
         }
+        return EXIT_FAILURE;
     }
-}
 
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <input_file> <xclbin>" << std::endl;
+    std::string backend_name = parser.value("backend");
+    if (backend_name.empty()) {
+        backend_name = parser.value("xclbin").empty() ? "cpu" : "opencl";
+    }
+    const int repeat = std::max(1, parser.value_to_int("repeat"));
+    const int num_contexts = std::max(1, parser.value_to_int("contexts"));
+    const int cus = std::max(0, parser.value_to_int("cus"));
+    const bool verify = parser.value("verify") == "true";
+#ifndef MUNKRES_CPU_ONLY
+    const bool whole_iteration = parser.value("per-step") != "true";
+    const bool auction = parser.value("auction") == "true";
+#endif
+    if ((backend_name == "opencl" || backend_name == "hybrid") && parser.value("xclbin").empty()) {
+        std::cerr << "The " << backend_name << " backend needs --xclbin" << std::endl;
         return EXIT_FAILURE;
     }
 
-    try {
-        // Initialize FPGA
-        std::string binaryFile = argv[2];
-        auto fileBuf = xcl::read_binary_file(binaryFile);
+    std::unique_ptr<TraceFile> trace;
+    if (!parser.value("trace").empty()) {
+        trace.reset(new TraceFile(parser.value("trace")));
+    }
 
-        // OpenCL setup
-        std::vector<cl::Device> devices = xcl::get_xil_devices();
-        if (devices.empty()) {
-            std::cerr << "No Xilinx devices found" << std::endl;
-            return EXIT_FAILURE;
+    try {
+        if (!parser.value("serve").empty()) {
+            // Everything a request needs is set up once: device programmed,
+            // kernels created.
+#ifndef MUNKRES_CPU_ONLY
+            std::unique_ptr<OpenClDevice> device;
+#endif
+            std::unique_ptr<MunkresContext> context;
+            if (backend_name == "cpu") {
+                context.reset(new MunkresContext(std::unique_ptr<SolverBackend>(new CpuBackend())));
+#ifndef MUNKRES_CPU_ONLY
+            } else if (backend_name == "opencl") {
+                device.reset(new OpenClDevice(parser.value("xclbin")));
+                context.reset(new MunkresContext(std::unique_ptr<SolverBackend>(
+                    new OpenClBackend(*device, cus > 0 ? 0 : -1, whole_iteration, auction))));
+#endif
+            } else {
+                std::cerr << "The service runs the cpu or opencl backend, not " << backend_name << std::endl;
+                return EXIT_FAILURE;
+            }
+            SolverService service(*context);
+            service.listen(parser.value("serve"));
+            std::cout << "Service: " << context->backend().name() << " backend ready on " << parser.value("serve")
+                      << " after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count()
+                      << " ms" << std::endl;
+            service.serve();
+            service.report(std::cout);
+            return EXIT_SUCCESS;
         }
-        
-        cl::Device device = devices[0];
-        cl::Context context(device);
-        cl::CommandQueue q(context, device, CL_QUEUE_PROFILING_ENABLE);
-        std::string device_name = device.getInfo<CL_DEVICE_NAME>();
-
-        // Create program from binary
-        cl::Program::Binaries bins;
-        bins.push_back({fileBuf.data(), fileBuf.size()});
-        devices.resize(1);
-        cl::Program program(context, devices, bins);
-        cl::Kernel krnl_find_uncovered(program, "find_uncovered_kernel");
-
-        OCL_CHECK(err, cl::Buffer buffer_matrix(context, CL_MEM_READ_ONLY, sizeof(double)*MAX_SIZE*MAX_SIZE, NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_mask_matrix(context, CL_MEM_READ_ONLY, sizeof(int)*MAX_SIZE*MAX_SIZE, NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_row_mask(context, CL_MEM_READ_ONLY, sizeof(bool), NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_col_mask(context, CL_MEM_READ_ONLY, sizeof(bool), NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_item(context, CL_MEM_READ_ONLY, sizeof(double), NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_size(context, CL_MEM_READ_ONLY, sizeof(size_t), NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_row_out(context, CL_MEM_WRITE_ONLY, sizeof(size_t), NULL, &err));
-        OCL_CHECK(err, cl::Buffer buffer_col_out(context, CL_MEM_WRITE_ONLY, sizeof(size_t), NULL, &err));
 
-
-        // Set kernel arguments
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(0, buffer_matrix));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(1, buffer_mask_matrix));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(2, buffer_row_mask));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(3, buffer_col_mask));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(4, buffer_item));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(5, buffer_size));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(6, buffer_row_out));
-        OCL_CHECK(err, err=krnl_find_uncovered.setArg(7, buffer_col_out));
-
-        OCL_CHECK(err, global_matrix = (double*)q.enqueueMapBuffer(buffer_matrix, CL_TRUE, CL_MAP_WRITE, 0, sizeof(double)*MAX_SIZE*MAX_SIZE, NULL, NULL, &err));
-        OCL_CHECK(err, global_mask_matrix = (double*)q.enqueueMapBuffer(buffer_mask_matrix, CL_TRUE, CL_MAP_WRITE, 0, sizeof(double)*MAX_SIZE*MAX_SIZE, NULL, NULL, &err));
-        OCL_CHECK(err, global_row_mask = (bool*)q.enqueueMapBuffer(buffer_row_mask, CL_TRUE, CL_MAP_WRITE, 0, sizeof(bool), NULL, NULL, &err));
-        OCL_CHECK(err, global_col_mask = (bool*)q.enqueueMapBuffer(buffer_col_mask, CL_TRUE, CL_MAP_WRITE, 0, sizeof(bool), NULL, NULL, &err));
-        OCL_CHECK(err, global_item = (double*)q.enqueueMapBuffer(buffer_item, CL_TRUE, CL_MAP_WRITE, 0, sizeof(double), NULL, NULL, &err));
-        OCL_CHECK(err, global_size = (size_t*)q.enqueueMapBuffer(buffer_size, CL_TRUE, CL_MAP_WRITE, 0, sizeof(size_t), NULL, NULL, &err));
-        OCL_CHECK(err, global_saverow = (size_t*)q.enqueueMapBuffer(buffer_row_out, CL_TRUE, CL_MAP_READ, 0, sizeof(size_t), NULL, NULL, &err));
-        OCL_CHECK(err, global_savecol= (size_t*)q.enqueueMapBuffer(buffer_col_out, CL_TRUE, CL_MAP_READ, 0, sizeof(size_t), NULL, NULL, &err));
-
-        // Read input file
-        std::ifstream file(argv[1]);
-        if (!file.is_open()) {
-            std::cerr << "Error opening file: " << argv[1] << std::endl;
-            return EXIT_FAILURE;
+        // Read input file: a matrix file (see matrixconverter) mapped as
+        // it is, or text read at once and parsed in parallel chunks
+        std::unique_ptr<MatrixFile> matrices;
+        std::vector<AssignmentProblem> problems;
+        if (MatrixFile::is_matrix_file(parser.value("input"))) {
+            matrices.reset(new MatrixFile(parser.value("input")));
+            if (matrices->count() == 0) {
+                std::cerr << "No matrices in " << parser.value("input") << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            std::string text;
+            try {
+                text = MatrixText::read_file(parser.value("input"));
+            } catch (const std::runtime_error &) {
+                std::cerr << "Error opening file: " << parser.value("input") << std::endl;
+                return EXIT_FAILURE;
+            }
+            if (!split_problems(MatrixText::parse(text.data(), text.data() + text.size()), parser.value("input"),
+                                problems)) {
+                return EXIT_FAILURE;
+            }
         }
 
-        std::string temp;
-        std::getline(file, temp);
-        std::stringstream ss(temp);
-        size_t rows, columns;
-        ss >> rows >> columns;
-
-        if (rows > MAX_SIZE || columns > MAX_SIZE) {
-            std::cerr << "Matrix size exceeds maximum allowed size of " << MAX_SIZE << std::endl;
-            return EXIT_FAILURE;
+        if (parser.value("stream") == "true" || !parser.value("connect").empty()) {
+            if (matrices) {
+                problems.resize(matrices->count());
+                for (size_t i = 0; i < problems.size(); i++) {
+                    read_mapped_problem(*matrices, i, problems[i]);
+                }
+            }
+            if (!parser.value("connect").empty()) {
+                return run_client(problems, parser.value("connect"), parser.value("stop-service") == "true", verify);
+            }
+            return run_stream(problems, backend_name, parser.value("xclbin"),
+                              parser.value_to_int("depth"), cus, parser.value("batch") == "true",
+                              parser.value("shard") == "true", num_contexts, verify);
         }
 
-        double matrix[MAX_SIZE][MAX_SIZE];
-        for (size_t row = 0; row < rows; row++) {
-            std::getline(file, temp);
-            std::stringstream ss(temp);
-            for (size_t col = 0; col < columns; col++) {
-                ss >> matrix[row][col];
+        // The solver reads double costs straight from the mapping; only
+        // the reference solver (with --verify) needs its own copy.
+        AssignmentProblem problem;
+        const double *costs;
+        if (matrices && matrices->dtype() == MatrixFile::DOUBLE) {
+            problem.rows = matrices->rows(0);
+            problem.columns = matrices->columns(0);
+            costs = matrices->data<double>(0);
+            if (verify) {
+                problem.costs.assign(costs, costs + problem.rows * problem.columns);
             }
+        } else {
+            if (matrices) {
+                read_mapped_problem(*matrices, 0, problem);
+            } else {
+                problem = std::move(problems[0]);
+            }
+            costs = problem.costs.data();
+        }
+        const size_t rows = problem.rows, columns = problem.columns;
+
+        // One context per thread, each with its own backend buffers (and
+        // for OpenCL its own command queue and kernel object).
+        std::vector<std::unique_ptr<MunkresContext>> contexts;
+        if (backend_name == "cpu") {
+            for (int i = 0; i < num_contexts; i++) {
+                contexts.emplace_back(new MunkresContext(std::unique_ptr<SolverBackend>(new CpuBackend())));
+            }
+#ifndef MUNKRES_CPU_ONLY
+        } else if (backend_name == "opencl") {
+            OpenClDevice device(parser.value("xclbin"));
+            for (int i = 0; i < num_contexts; i++) {
+                const int cu = cus > 0 ? i % cus : -1;
+                contexts.emplace_back(new MunkresContext(std::unique_ptr<SolverBackend>(
+                    new OpenClBackend(device, cu, whole_iteration, auction))));
+            }
+        } else if (backend_name == "hybrid") {
+            // Time both backends once, then route every solve by size. The
+            // device is fitted separately on the sizes it holds on chip and
+            // on the larger ones, which take a launch per search.
+            OpenClDevice device(parser.value("xclbin"));
+            const std::vector<size_t> on_chip_sizes{4, 16, 48, 96, 160};
+            const std::vector<size_t> off_chip_sizes{288, 384, 512};
+            std::vector<size_t> sizes(on_chip_sizes);
+            sizes.insert(sizes.end(), off_chip_sizes.begin(), off_chip_sizes.end());
+            MunkresContext host_probe(std::unique_ptr<SolverBackend>(new CpuBackend()));
+            MunkresContext device_probe(std::unique_ptr<SolverBackend>(
+                new OpenClBackend(device, cus > 0 ? 0 : -1, whole_iteration, auction)));
+            const LatencyModel host_model = calibrate(host_probe, sizes, 3);
+            DeviceLatencyModel device_model;
+            if (whole_iteration || auction) {
+                device_model.on_chip_max = ITERATION_MAX_SIZE;
+                device_model.on_chip = calibrate(device_probe, on_chip_sizes, 3);
+                device_model.off_chip = calibrate(device_probe, off_chip_sizes, 3);
+            } else {
+                device_model.off_chip = calibrate(device_probe, sizes, 3);
+            }
+            log_calibration(std::cout, host_model, device_model, sizeof(device_cost_t));
+            for (int i = 0; i < num_contexts; i++) {
+                const int cu = cus > 0 ? i % cus : -1;
+                contexts.emplace_back(new MunkresContext(std::unique_ptr<SolverBackend>(new HybridBackend(
+                    std::unique_ptr<SolverBackend>(new CpuBackend()),
+                    std::unique_ptr<SolverBackend>(new OpenClBackend(device, cu, whole_iteration, auction)),
+                    host_model, device_model))));
+            }
+#endif
+        } else {
+            std::cerr << "Unknown or unavailable backend: " << backend_name << std::endl;
+            return EXIT_FAILURE;
         }
 
-        // Display begin matrix state
-        std::cout << "\nInitial matrix state:" << std::endl;
-        for (size_t row = 0; row < rows; row++) {
-            for (size_t col = 0; col < columns; col++) {
-                std::cout.width(2);
-                std::cout << matrix[row][col] << ",";
+        const bool print = rows <= 16 && columns <= 16;
+        if (print) {
+            std::cout << "\nInitial matrix state:" << std::endl;
+            for (size_t row = 0; row < rows; row++) {
+                for (size_t col = 0; col < columns; col++) {
+                    std::cout.width(2);
+                    std::cout << costs[row * columns + col] << ",";
+                }
+                std::cout << std::endl;
             }
             std::cout << std::endl;
         }
-        std::cout << std::endl;
 
-        // Solve the assignment problem
-        solve_munkres(matrix, rows, columns, context, q, krnl_find_uncovered);
+        // Solve the assignment problem, every context on its own thread
+        std::vector<std::vector<double>> results(contexts.size());
+        std::vector<double> solve_ms(contexts.size(), 0);
+        std::vector<std::thread> threads;
+        auto wall_start = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < contexts.size(); c++) {
+            threads.emplace_back([&, c]() {
+                for (int i = 0; i < repeat; i++) {
+                    results[c].resize(rows * columns);
+                    auto start = std::chrono::steady_clock::now();
+                    contexts[c]->solve(costs, rows, columns, results[c].data());
+                    solve_ms[c] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
 
-        // Display solved matrix
-        std::cout << "Solved matrix state:" << std::endl;
-        for (size_t row = 0; row < rows; row++) {
-            for (size_t col = 0; col < columns; col++) {
-                std::cout.width(2);
-                std::cout << matrix[row][col] << ",";
+        const std::vector<double> &matrix = results[0];
+        if (print) {
+            std::cout << "Solved matrix state:" << std::endl;
+            for (size_t row = 0; row < rows; row++) {
+                for (size_t col = 0; col < columns; col++) {
+                    std::cout.width(2);
+                    std::cout << matrix[row * columns + col] << ",";
+                }
+                std::cout << std::endl;
             }
             std::cout << std::endl;
         }
-        std::cout << std::endl;
 
-        // Verify solution
-        for (size_t row = 0; row < rows; row++) {
-            int rowcount = 0;
-            for (size_t col = 0; col < columns; col++) {
-                if (matrix[row][col] == 0)
-                    rowcount++;
+        for (size_t c = 0; c < contexts.size(); c++) {
+            std::cout << "Context " << c << ": backend " << contexts[c]->backend().name() << ", "
+                      << rows << "x" << columns << ", average solve time: " << solve_ms[c] / repeat
+                      << " ms over " << repeat << " runs" << std::endl;
+            contexts[c]->backend().report(std::cout);
+        }
+        std::cout << "Throughput: " << contexts.size() * repeat / wall_s << " solves/s with "
+                  << contexts.size() << " contexts" << std::endl;
+
+        // Verify solutions
+        bool valid = true;
+        for (size_t c = 0; c < contexts.size(); c++) {
+            if (!check_assignment(results[c], rows, columns)) {
+                std::cerr << "Context " << c << " returned an invalid assignment" << std::endl;
+                valid = false;
             }
-            if (rowcount != 1)
-                std::cerr << "Row " << row << " has " << rowcount << " columns that have been matched." << std::endl;
         }
 
-        for (size_t col = 0; col < columns; col++) {
-            int colcount = 0;
-            for (size_t row = 0; row < rows; row++) {
-                if (matrix[row][col] == 0)
-                    colcount++;
+        if (verify) {
+            // An assignment optimal for costs each off by at most e is
+            // within 2 e per assigned pair of the optimum.
+            const double expected_cost = reference_cost(problem);
+            for (size_t c = 0; c < contexts.size(); c++) {
+                const double cost = assignment_cost(costs, results[c]);
+                const double tolerance = 2 * std::max(rows, columns) * contexts[c]->backend().quantization_error();
+                if (c == 0) {
+                    std::cout << "Assignment cost: " << cost << ", reference: " << expected_cost << std::endl;
+                    if (tolerance > 0) {
+                        std::cout << "Precision loss: " << cost - expected_cost << " (bound " << tolerance << ")" << std::endl;
+                    }
+                }
+                if (std::fabs(cost - expected_cost) > tolerance) {
+                    std::cerr << "Context " << c << " found cost " << cost << std::endl;
+                    valid = false;
+                }
             }
-            if (colcount != 1)
-                std::cerr << "Column " << col << " has " << colcount << " rows that have been matched." << std::endl;
         }
 
-        return EXIT_SUCCESS;
+        std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+        return valid ? EXIT_SUCCESS : EXIT_FAILURE;
     }
     catch (const std::exception& e) {
         std::cerr << "Error in main: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
-} 
+}
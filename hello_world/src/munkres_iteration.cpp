@@ -0,0 +1,53 @@
+#include "ap_int.h"
+#include "cost_type.h"
+#include "munkres_steps.h"
+
+// Largest matrix held on chip; the host solves larger ones with
+// find_uncovered_kernel. Must match ITERATION_MAX_SIZE in opencl_backend.h.
+#define MAX_SIZE 256
+
+extern "C" {
+
+// Steps 2 to 5 of the Munkres algorithm in one launch: the reduced
+// matrix (dense, rows size apart, size up to MAX_SIZE) is loaded into
+// on-chip memory once and the cover, prime, augment and step 5 loop runs
+// there (munkres_steps.h) until every row is starred.
+//
+// stars holds the column starred in each row (-1 for none) on entry,
+// the stars of step 1, and the final assignment on return.
+void munkres_iteration_kernel(
+    const cost_t *matrix,
+    int *stars,
+    ap_uint<32> size
+) {
+#pragma HLS INTERFACE m_axi port = matrix offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = stars offset = slave bundle = gmem
+#pragma HLS INTERFACE s_axilite port = size bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    static cost_t local[MAX_SIZE][MAX_SIZE];
+    int star_col[MAX_SIZE];
+
+    load_rows: for (ap_uint<32> row = 0; row < size; row++) {
+        load_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+            local[row][col] = matrix[row * size + col];
+        }
+    }
+    load_stars: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+        star_col[row] = stars[row];
+    }
+
+    munkres_steps<MAX_SIZE>(local, star_col, size);
+
+    store_stars: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = MAX_SIZE
+        stars[row] = star_col[row];
+    }
+}
+
+}
@@ -0,0 +1,191 @@
+// C simulation testbench: runs the kernels as plain C++ functions behind
+// the host solver and checks the device paths, one find_uncovered_kernel
+// launch per prime with step5_kernel, a single munkres_iteration_kernel
+// launch, and the latter after preprocess_kernel reduced and starred the
+// matrix, against the CPU reference. The costs are small integers, exact in every
+// COST_TYPE, so the assignments must match exactly. Matrices larger than
+// the iteration kernel holds take the per step path, as on the device.
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ap_int.h"
+#include "cost_type.h"
+#include "cover_bits.h"
+#include "cpu_backend.h"
+#include "munkres_context.h"
+#include "munkres.h"
+
+extern "C" {
+void find_uncovered_kernel(const cost_t *matrix, const ap_uint<32> *row_cover, const ap_uint<32> *col_cover,
+                           const double item, ap_uint<32> size, ap_uint<32> *row_out, ap_uint<32> *col_out,
+                           bool *found);
+void munkres_iteration_kernel(const cost_t *matrix, int *stars, ap_uint<32> size);
+void step5_kernel(cost_t *matrix, const ap_uint<32> *row_cover, const ap_uint<32> *col_cover, ap_uint<32> size);
+void preprocess_kernel(const double *input, cost_t *matrix, int *stars, ap_uint<32> size, bool rows_first);
+}
+
+// Largest matrix munkres_iteration_kernel holds; see opencl_backend.h.
+const size_t ITERATION_MAX_SIZE = 256;
+
+// The CPU backend with the offloaded operations replaced by kernel calls.
+// As on the device, the reduced matrix is converted to cost_t once and
+// stays "resident": step5_kernel updates that copy, not the host's.
+class CsimBackend : public CpuBackend {
+public:
+    CsimBackend(bool whole_iteration, bool preprocess)
+        : m_whole_iteration(whole_iteration), m_preprocess(preprocess) {}
+
+    const char *name() const override {
+        if (m_preprocess) {
+            return m_whole_iteration ? "preprocess+munkres_iteration" : "preprocess+find_uncovered";
+        }
+        return m_whole_iteration ? "munkres_iteration" : "find_uncovered";
+    }
+
+    bool find_uncovered_zero(size_t &row, size_t &col) override {
+        upload_masks();
+        ap_uint<32> row_out = 0, col_out = 0;
+        bool found = false;
+        find_uncovered_kernel(m_device.data(), m_row_cover.data(), m_col_cover.data(), 0.0, state().size, &row_out,
+                              &col_out, &found);
+        row = row_out;
+        col = col_out;
+        return found;
+    }
+
+    bool solve_from_stars(int *stars) override {
+        if (!m_whole_iteration || state().size > ITERATION_MAX_SIZE) {
+            return false;
+        }
+        munkres_iteration_kernel(m_device.data(), stars, state().size);
+        return true;
+    }
+
+    void reduce(bool rows_first) override {
+        CpuBackend::reduce(rows_first);
+        const MunkresState &s = state();
+        m_device.resize(s.size * s.size);
+        for (size_t i = 0; i < m_device.size(); i++) {
+            m_device[i] = cost_t(s.matrix.data[i]);
+        }
+    }
+
+    bool reduce_and_star(bool rows_first, int *stars) override {
+        if (!m_preprocess) {
+            return false;
+        }
+        const MunkresState &s = state();
+        m_device.resize(s.size * s.size);
+        preprocess_kernel(s.matrix.data, m_device.data(), stars, s.size, rows_first);
+        std::fill(s.row_mask, s.row_mask + s.size, 0);
+        std::fill(s.col_mask, s.col_mask + s.size, 0);
+        return true;
+    }
+
+    void step5() override {
+        upload_masks();
+        step5_kernel(m_device.data(), m_row_cover.data(), m_col_cover.data(), state().size);
+    }
+
+private:
+    void upload_masks() {
+        const MunkresState &s = state();
+        m_row_cover.resize(cover_words(s.size));
+        m_col_cover.resize(cover_words(s.size));
+        pack_covers(s.row_mask, s.size, m_row_cover.data());
+        pack_covers(s.col_mask, s.size, m_col_cover.data());
+    }
+
+    bool m_whole_iteration;
+    bool m_preprocess;
+    std::vector<cost_t> m_device;
+    std::vector<ap_uint<32>> m_row_cover, m_col_cover;
+};
+
+static double assignment_cost(const std::vector<double> &costs, const std::vector<double> &solution) {
+    double total = 0;
+    for (size_t i = 0; i < costs.size(); i++) {
+        if (solution[i] == 0) {
+            total += costs[i];
+        }
+    }
+    return total;
+}
+
+static double reference_cost(const std::vector<double> &costs, size_t rows, size_t columns) {
+    Matrix<double> matrix(rows, columns);
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < columns; col++) {
+            matrix(row, col) = costs[row * columns + col];
+        }
+    }
+    Munkres<double> munkres;
+    munkres.solve(matrix);
+    double total = 0;
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < columns; col++) {
+            if (matrix(row, col) == 0) {
+                total += costs[row * columns + col];
+            }
+        }
+    }
+    return total;
+}
+
+int main() {
+    struct Case {
+        size_t rows, columns;
+        int range;      // values are drawn from [0, range): small ranges give many ties
+        bool infinite;  // sprinkle infinities
+    };
+    const Case cases[] = {
+        {1, 1, 10, false},    {2, 2, 3, false},     {5, 5, 100, false},  {10, 10, 1000, false},
+        {16, 16, 4, false},   {37, 37, 500, false}, {20, 35, 50, false}, {35, 20, 50, false},
+        {64, 64, 10, true},   {100, 100, 1000, false}, {256, 256, 10000, false}, {300, 300, 10000, false},
+        {260, 513, 1000, false},
+    };
+
+    MunkresContext reference(std::unique_ptr<SolverBackend>(new CpuBackend()));
+    MunkresContext per_step(std::unique_ptr<SolverBackend>(new CsimBackend(false, false)));
+    MunkresContext iteration(std::unique_ptr<SolverBackend>(new CsimBackend(true, false)));
+    MunkresContext preprocessed(std::unique_ptr<SolverBackend>(new CsimBackend(true, true)));
+    MunkresContext *paths[] = {&per_step, &iteration, &preprocessed};
+
+    std::mt19937 generator(42);
+    bool valid = true;
+    for (const Case &c : cases) {
+        std::uniform_int_distribution<int> value(0, c.range - 1);
+        std::vector<double> costs(c.rows * c.columns);
+        for (size_t i = 0; i < costs.size(); i++) {
+            costs[i] = value(generator);
+            if (c.infinite && i % 7 == 3) {
+                costs[i] = std::numeric_limits<double>::infinity();
+            }
+        }
+
+        std::vector<double> expected = costs;
+        reference.solve(expected.data(), c.rows, c.columns);
+        if (assignment_cost(costs, expected) != reference_cost(costs, c.rows, c.columns)) {
+            std::cerr << c.rows << "x" << c.columns << ": CPU reference is not optimal" << std::endl;
+            valid = false;
+        }
+
+        for (MunkresContext *path : paths) {
+            std::vector<double> result = costs;
+            path->solve(result.data(), c.rows, c.columns);
+            const bool same = (result == expected);
+            std::cout << c.rows << "x" << c.columns << " " << path->backend().name() << ": "
+                      << (same ? "matches" : "differs from") << " the CPU reference" << std::endl;
+            valid = valid && same;
+        }
+    }
+
+    std::cout << "Cost type: " << COST_NAME << std::endl;
+    std::cout << "TEST " << (valid ? "PASSED" : "FAILED") << std::endl;
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "ap_int.h"
+#include "cost_type.h"
+
+// Steps 2 to 5 of the Munkres algorithm on a reduced matrix held in
+// local memory, shared by the kernels that solve on chip. star_col holds
+// the column starred in each row (-1 for none): the stars of step 1 on
+// entry, the final assignment on return. The order of the searches and
+// the step 5 arithmetic are those of the host (cpu_backend.cpp), so both
+// return the same assignment.
+template <int N>
+void munkres_steps(cost_t local[N][N], int star_col[N], ap_uint<32> size) {
+#pragma HLS INLINE off
+    int star_row[N];   // row of the star in each column
+    int prime_col[N];  // column of the prime in each row
+    bool row_cover[N];
+    bool col_cover[N];
+
+    init_stars: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = N
+        star_row[i] = -1;
+        prime_col[i] = -1;
+        row_cover[i] = false;
+    }
+    index_stars: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = N
+        if (star_col[row] >= 0) {
+            star_row[star_col[row]] = row;
+        }
+    }
+
+    assignment_loop: for (;;) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = N
+        // Step 2: cover the columns holding a star
+        ap_uint<32> covered = 0;
+        cover_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+            col_cover[col] = star_row[col] >= 0;
+            if (col_cover[col]) {
+                covered++;
+            }
+        }
+        if (covered >= size) {
+            break;
+        }
+
+        bool augmented = false;
+        prime_loop: while (!augmented) {
+            // Step 3: first uncovered zero in row major order
+            bool found = false;
+            ap_uint<32> zero_row = 0, zero_col = 0;
+            search_rows: for (ap_uint<32> row = 0; row < size && !found; row++) {
+                if (!row_cover[row]) {
+                    search_cols: for (ap_uint<32> col = 0; col < size && !found; col++) {
+#pragma HLS PIPELINE II = 1
+                        if (!col_cover[col] && local[row][col] == 0) {
+                            zero_row = row;
+                            zero_col = col;
+                            found = true;
+                        }
+                    }
+                }
+            }
+
+            if (!found) {
+                // Step 5: h = smallest uncovered value, added to the
+                // covered rows and subtracted from the uncovered columns
+                cost_t h = 0;
+                bool have_h = false;
+                min_rows: for (ap_uint<32> row = 0; row < size; row++) {
+                    min_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+                        if (!row_cover[row] && !col_cover[col] && (!have_h || local[row][col] < h)) {
+                            h = local[row][col];
+                            have_h = true;
+                        }
+                    }
+                }
+                update_rows: for (ap_uint<32> row = 0; row < size; row++) {
+                    update_cols: for (ap_uint<32> col = 0; col < size; col++) {
+#pragma HLS PIPELINE II = 1
+                        cost_t value = local[row][col];
+                        if (row_cover[row]) {
+                            value += h;
+                        }
+                        if (!col_cover[col]) {
+                            value -= h;
+                        }
+                        local[row][col] = value;
+                    }
+                }
+                continue;
+            }
+
+            prime_col[zero_row] = zero_col;
+            if (star_col[zero_row] >= 0) {
+                row_cover[zero_row] = true;
+                col_cover[star_col[zero_row]] = false;
+                continue;
+            }
+
+            // Step 4: star the primes and unstar the stars along the
+            // alternating path starting at the new prime
+            int row = zero_row, col = zero_col;
+            augment: for (;;) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = N
+                int next_row = star_row[col];
+                star_col[row] = col;
+                star_row[col] = row;
+                if (next_row < 0) {
+                    break;
+                }
+                row = next_row;
+                col = prime_col[row];
+            }
+
+            clear_primes: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+                prime_col[i] = -1;
+                row_cover[i] = false;
+            }
+            augmented = true;
+        }
+    }
+
+}
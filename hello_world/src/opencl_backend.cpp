@@ -0,0 +1,479 @@
+#include "opencl_backend.h"
+#include "auction_plan.h"
+#include "cover_bits.h"
+#include "cpu_backend.h"
+#include "timeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+static const bool zero_copy_matrix = std::is_same<device_cost_t, double>::value;
+
+OpenClDevice::OpenClDevice(const std::string &xclbin) {
+    auto fileBuf = xcl::read_binary_file(xclbin);
+
+    std::vector<cl::Device> devices = xcl::get_xil_devices();
+    if (devices.empty()) {
+        throw std::runtime_error("No Xilinx devices found");
+    }
+    program_device(devices[0], fileBuf);
+}
+
+OpenClDevice::OpenClDevice(const cl::Device &device, const std::vector<unsigned char> &binary) {
+    program_device(device, binary);
+}
+
+void OpenClDevice::program_device(const cl::Device &xil_device, const std::vector<unsigned char> &binary) {
+    cl_int err;
+    device = xil_device;
+    OCL_CHECK(err, context = cl::Context(device, NULL, NULL, NULL, &err));
+
+    cl::Program::Binaries bins{{binary.data(), binary.size()}};
+    OCL_CHECK(err, program = cl::Program(context, {device}, bins, NULL, &err));
+}
+
+std::vector<std::unique_ptr<OpenClDevice>> OpenClDevice::open_all(const std::string &xclbin) {
+    auto fileBuf = xcl::read_binary_file(xclbin);
+
+    std::vector<cl::Device> devices = xcl::get_xil_devices();
+    if (devices.empty()) {
+        throw std::runtime_error("No Xilinx devices found");
+    }
+    std::vector<std::unique_ptr<OpenClDevice>> opened;
+    for (const cl::Device &device : devices) {
+        opened.emplace_back(new OpenClDevice(device, fileBuf));
+    }
+    return opened;
+}
+
+std::string OpenClDevice::compute_unit(const std::string &kernel, int cu) {
+    if (cu < 0) {
+        return kernel;
+    }
+    return kernel + ":{" + kernel + "_" + std::to_string(cu + 1) + "}";
+}
+
+OpenClBackend::OpenClBackend(OpenClDevice &device, int cu, bool whole_iteration, bool auction)
+    : m_context(device.context), m_row_out(1), m_col_out(1), m_found(1) {
+    cl_int err;
+    OCL_CHECK(err, m_q = cl::CommandQueue(device.context, device.device, CL_QUEUE_PROFILING_ENABLE, &err));
+    OCL_CHECK(err, m_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("find_uncovered_kernel", cu).c_str(), &err));
+
+    // Older xclbins only hold find_uncovered_kernel: keep the per step path.
+    if (whole_iteration) {
+        m_iteration_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("munkres_iteration_kernel", cu).c_str(), &err);
+        m_whole_iteration = (err == CL_SUCCESS);
+        if (!m_whole_iteration) {
+            std::cout << "munkres_iteration_kernel not found, searching per step" << std::endl;
+        }
+    }
+
+    m_step5_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("step5_kernel", cu).c_str(), &err);
+    m_device_step5 = (err == CL_SUCCESS);
+    m_preprocess_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("preprocess_kernel", cu).c_str(), &err);
+    m_device_preprocess = (err == CL_SUCCESS);
+    if (auction) {
+        m_auction_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("auction_kernel", cu).c_str(), &err);
+        m_auction = (err == CL_SUCCESS);
+        if (!m_auction) {
+            std::cout << "auction_kernel not found, running the Hungarian steps" << std::endl;
+        }
+    }
+
+    OCL_CHECK(err, m_row_out_buffer = cl::Buffer(device.context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+        sizeof(cl_uint), m_row_out.data(), &err));
+    OCL_CHECK(err, m_col_out_buffer = cl::Buffer(device.context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+        sizeof(cl_uint), m_col_out.data(), &err));
+    OCL_CHECK(err, m_found_buffer = cl::Buffer(device.context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+        sizeof(char), m_found.data(), &err));
+
+    OCL_CHECK(err, err = m_kernel.setArg(3, 0.0));
+    OCL_CHECK(err, err = m_kernel.setArg(5, m_row_out_buffer));
+    OCL_CHECK(err, err = m_kernel.setArg(6, m_col_out_buffer));
+    OCL_CHECK(err, err = m_kernel.setArg(7, m_found_buffer));
+}
+
+OpenClBackend::~OpenClBackend() {
+    unmap();
+}
+
+void OpenClBackend::unmap() {
+    if (m_capacity == 0) {
+        return;
+    }
+    cl_int err;
+    OCL_CHECK(err, err = m_q.enqueueUnmapMemObject(m_matrix_store, m_mapped_matrix));
+    OCL_CHECK(err, err = m_q.enqueueUnmapMemObject(m_stars_store, m_mapped_stars));
+    OCL_CHECK(err, err = m_q.finish());
+    m_mapped_matrix = nullptr;
+    m_mapped_stars = nullptr;
+    m_capacity = 0;
+}
+
+void OpenClBackend::grow(size_t size) {
+    unmap();
+    cl_int err;
+    // step5_kernel updates the matrix in place.
+    OCL_CHECK(err, m_matrix_store = cl::Buffer(m_context, CL_MEM_ALLOC_HOST_PTR | CL_MEM_READ_WRITE,
+        sizeof(device_cost_t) * size * size, nullptr, &err));
+    OCL_CHECK(err, m_stars_store = cl::Buffer(m_context, CL_MEM_ALLOC_HOST_PTR | CL_MEM_READ_WRITE,
+        sizeof(cl_int) * size, nullptr, &err));
+    OCL_CHECK(err, m_mapped_matrix = static_cast<device_cost_t *>(m_q.enqueueMapBuffer(
+        m_matrix_store, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, sizeof(device_cost_t) * size * size, nullptr,
+        nullptr, &err)));
+    OCL_CHECK(err, m_mapped_stars = static_cast<cl_int *>(m_q.enqueueMapBuffer(
+        m_stars_store, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, sizeof(cl_int) * size, nullptr, nullptr, &err)));
+    m_capacity = size;
+}
+
+void OpenClBackend::resize(size_t size) {
+    if (size == m_state.size) {
+        return;
+    }
+    cl_int err;
+    if (size > m_capacity) {
+        grow(size);
+    }
+    if (!zero_copy_matrix) {
+        m_matrix.resize(size * size);
+    }
+    m_row_mask.resize(size);
+    m_col_mask.resize(size);
+    m_row_cover.resize(cover_words(size));
+    m_col_cover.resize(cover_words(size));
+    m_device_row_cover.resize(cover_words(size));
+    m_device_col_cover.resize(cover_words(size));
+
+    m_state.matrix.data = zero_copy_matrix ? reinterpret_cast<double *>(m_mapped_matrix) : m_matrix.data();
+    m_state.matrix.size = size;
+    m_state.row_mask = m_row_mask.data();
+    m_state.col_mask = m_col_mask.data();
+    m_state.size = size;
+
+    // Sub-buffers at offset 0 always meet the base address alignment.
+    cl_buffer_region matrix_region = {0, sizeof(device_cost_t) * size * size};
+    cl_buffer_region stars_region = {0, sizeof(cl_int) * size};
+    OCL_CHECK(err, m_matrix_buffer = m_matrix_store.createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION,
+        &matrix_region, &err));
+    OCL_CHECK(err, m_stars_buffer = m_stars_store.createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION,
+        &stars_region, &err));
+    // Written a span of words at a time, never migrated whole.
+    OCL_CHECK(err, m_row_cover_buffer = cl::Buffer(m_context, CL_MEM_READ_ONLY,
+        sizeof(cl_uint) * cover_words(size), nullptr, &err));
+    OCL_CHECK(err, m_col_cover_buffer = cl::Buffer(m_context, CL_MEM_READ_ONLY,
+        sizeof(cl_uint) * cover_words(size), nullptr, &err));
+    m_covers_synced = false;
+    m_matrix_dirty = true;
+
+    OCL_CHECK(err, err = m_kernel.setArg(0, m_matrix_buffer));
+    OCL_CHECK(err, err = m_kernel.setArg(1, m_row_cover_buffer));
+    OCL_CHECK(err, err = m_kernel.setArg(2, m_col_cover_buffer));
+    OCL_CHECK(err, err = m_kernel.setArg(4, static_cast<cl_uint>(size)));
+    if (m_whole_iteration) {
+        OCL_CHECK(err, err = m_iteration_kernel.setArg(0, m_matrix_buffer));
+        OCL_CHECK(err, err = m_iteration_kernel.setArg(1, m_stars_buffer));
+        OCL_CHECK(err, err = m_iteration_kernel.setArg(2, static_cast<cl_uint>(size)));
+    }
+    if (m_device_preprocess && zero_copy_matrix) {
+        OCL_CHECK(err, err = m_preprocess_kernel.setArg(0, m_matrix_buffer));
+        OCL_CHECK(err, err = m_preprocess_kernel.setArg(1, m_matrix_buffer));
+        OCL_CHECK(err, err = m_preprocess_kernel.setArg(2, m_stars_buffer));
+        OCL_CHECK(err, err = m_preprocess_kernel.setArg(3, static_cast<cl_uint>(size)));
+    }
+    if (m_auction) {
+        OCL_CHECK(err, m_prices_buffer = cl::Buffer(m_context, CL_MEM_READ_WRITE, sizeof(device_cost_t) * size, nullptr, &err));
+        OCL_CHECK(err, err = m_auction_kernel.setArg(0, m_matrix_buffer));
+        OCL_CHECK(err, err = m_auction_kernel.setArg(1, m_prices_buffer));
+        OCL_CHECK(err, err = m_auction_kernel.setArg(2, m_stars_buffer));
+        OCL_CHECK(err, err = m_auction_kernel.setArg(3, static_cast<cl_uint>(size)));
+    }
+    if (m_device_step5) {
+        OCL_CHECK(err, err = m_step5_kernel.setArg(0, m_matrix_buffer));
+        OCL_CHECK(err, err = m_step5_kernel.setArg(1, m_row_cover_buffer));
+        OCL_CHECK(err, err = m_step5_kernel.setArg(2, m_col_cover_buffer));
+        OCL_CHECK(err, err = m_step5_kernel.setArg(3, static_cast<cl_uint>(size)));
+    }
+}
+
+void OpenClBackend::reduce(bool rows_first) {
+    cpu_reduce(m_state, rows_first);
+
+    m_quantizer.set_scale(m_state);
+    if (!zero_copy_matrix) {
+        m_quantizer.quantize(m_state, m_mapped_matrix, true);
+    }
+
+    m_matrix_dirty = true;
+    // Force the first search to upload both covers.
+    m_covers_synced = false;
+}
+
+bool OpenClBackend::reduce_and_star(bool rows_first, int *stars) {
+    const size_t size = m_state.size;
+    // The host must never need the reduced matrix afterwards. A narrower
+    // cost type would upload more than the quantized matrix and lose track
+    // of the quantization error, so only double matrices are preprocessed.
+    // The auction reads the reduced matrix on the host for its epsilons.
+    const bool device_steps = (m_whole_iteration && size <= ITERATION_MAX_SIZE) || m_device_step5;
+    if ((m_auction && size <= AUCTION_MAX_SIZE) || !m_device_preprocess || !zero_copy_matrix || !device_steps || size > PREPROCESS_MAX_SIZE) {
+        return false;
+    }
+
+    // The input and the reduced matrix share the buffer: the last pass
+    // reads every cost before overwriting it.
+    cl_int err;
+    OCL_CHECK(err, err = m_preprocess_kernel.setArg(4, static_cast<cl_uchar>(rows_first)));
+    cl::Event upload;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects({m_matrix_buffer}, 0 /* 0 means from host*/, nullptr, &upload));
+    m_bytes_to_device += sizeof(double) * size * size;
+    cl::Event event;
+    OCL_CHECK(err, err = m_q.enqueueTask(m_preprocess_kernel, nullptr, &event));
+    cl::Event download;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects({m_stars_buffer}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, &download));
+    m_bytes_from_device += sizeof(cl_int) * size;
+    OCL_CHECK(err, err = m_q.finish());
+
+    m_transfer_ns += elapsed_ns(upload, "transfer", "upload input");
+    m_kernel_ns += elapsed_ns(event, "kernel", "preprocess_kernel");
+    elapsed_ns(download, "transfer", "download stars");
+    m_preprocess_launches++;
+    std::copy(m_mapped_stars, m_mapped_stars + size, stars);
+
+    // The reduced matrix is on the device; the masks start clear.
+    std::fill(m_row_mask.begin(), m_row_mask.end(), 0);
+    std::fill(m_col_mask.begin(), m_col_mask.end(), 0);
+    m_covers_synced = false;
+    m_matrix_dirty = false;
+    return true;
+}
+
+void OpenClBackend::step5() {
+    if (!m_device_step5) {
+        cpu_step5(m_state);
+        m_matrix_dirty = true;
+        return;
+    }
+
+    // The matrix is updated where it lives: only the changed cover words
+    // go over.
+    cl_int err;
+    std::vector<cl::Memory> inBufVec;
+    upload_matrix(inBufVec);
+    std::vector<cl::Event> uploads(inBufVec.size() ? 1 : 0);
+    if (!inBufVec.empty()) {
+        OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects(inBufVec, 0 /* 0 means from host*/, nullptr, &uploads[0]));
+    }
+    upload_masks(uploads);
+    cl::Event event;
+    OCL_CHECK(err, err = m_q.enqueueTask(m_step5_kernel, nullptr, &event));
+    OCL_CHECK(err, err = m_q.finish());
+
+    for (const cl::Event &upload : uploads) {
+        m_transfer_ns += elapsed_ns(upload, "transfer", "upload");
+    }
+    m_kernel_ns += elapsed_ns(event, "kernel", "step5_kernel");
+    m_step5_launches++;
+}
+
+cl_ulong elapsed_ns(const cl::Event &event, const char *category, const char *name) {
+    cl_int err;
+    cl_ulong time_start, time_end;
+    OCL_CHECK(err, err = event.getProfilingInfo(CL_PROFILING_COMMAND_START, &time_start));
+    OCL_CHECK(err, err = event.getProfilingInfo(CL_PROFILING_COMMAND_END, &time_end));
+
+    Timeline *trace = timeline();
+    if (trace && name) {
+        TimelineEvent traced;
+        traced.name = name;
+        traced.category = category;
+        traced.device = true;
+        traced.thread = Timeline::thread_id();
+        OCL_CHECK(err, err = event.getProfilingInfo(CL_PROFILING_COMMAND_QUEUED, &traced.queued_ns));
+        OCL_CHECK(err, err = event.getProfilingInfo(CL_PROFILING_COMMAND_SUBMIT, &traced.submit_ns));
+        traced.start_ns = time_start;
+        traced.end_ns = time_end;
+        trace->observe_device_clock(time_end, Timeline::now_ns());
+        trace->record(traced);
+    }
+    return time_end - time_start;
+}
+
+void OpenClBackend::upload_matrix(std::vector<cl::Memory> &buffers) {
+    if (m_matrix_dirty) {
+        if (!zero_copy_matrix) {
+            m_quantizer.quantize(m_state, m_mapped_matrix, false);
+        }
+        buffers.push_back(m_matrix_buffer);
+        m_bytes_to_device += sizeof(device_cost_t) * m_state.size * m_state.size;
+        m_matrix_uploads++;
+        m_matrix_dirty = false;
+    }
+}
+
+void OpenClBackend::upload_cover(const std::vector<char> &mask, std::vector<cl_uint, aligned_allocator<cl_uint>> &cover,
+                                 std::vector<cl_uint> &device_cover, const cl::Buffer &buffer,
+                                 std::vector<cl::Event> &events) {
+    pack_covers(mask.data(), m_state.size, cover.data());
+    size_t first = 0, last = cover.size();
+    if (m_covers_synced) {
+        while (first < last && cover[first] == device_cover[first]) {
+            first++;
+        }
+        while (last > first && cover[last - 1] == device_cover[last - 1]) {
+            last--;
+        }
+    }
+    if (first == last) {
+        return;
+    }
+
+    cl_int err;
+    cl::Event event;
+    const size_t bytes = sizeof(cl_uint) * (last - first);
+    OCL_CHECK(err, err = m_q.enqueueWriteBuffer(buffer, CL_FALSE, sizeof(cl_uint) * first, bytes, &cover[first],
+                                                nullptr, &event));
+    events.push_back(event);
+    std::copy(cover.begin() + first, cover.begin() + last, device_cover.begin() + first);
+    m_bytes_to_device += bytes;
+    m_mask_bytes += bytes;
+    // A flag per line, as the masks went over before they were packed
+    m_unpacked_mask_bytes += m_state.size;
+}
+
+void OpenClBackend::upload_masks(std::vector<cl::Event> &events) {
+    upload_cover(m_row_mask, m_row_cover, m_device_row_cover, m_row_cover_buffer, events);
+    upload_cover(m_col_mask, m_col_cover, m_device_col_cover, m_col_cover_buffer, events);
+    m_covers_synced = true;
+}
+
+void OpenClBackend::auction(int *stars) {
+    const size_t size = m_state.size;
+    const double unit = cost_unit(m_quantizer.scale());
+    double largest = 0;
+    for (size_t i = 0; i < size * size; i++) {
+        largest = std::max(largest, m_state.matrix.data[i]);
+    }
+    const std::vector<double> schedule = epsilon_schedule(largest * unit, size, unit);
+
+    // The phases queue up behind the upload; each launch takes the
+    // arguments set when it was enqueued.
+    cl_int err;
+    std::vector<cl::Memory> inBufVec;
+    upload_matrix(inBufVec);
+    std::vector<cl::Event> uploads(inBufVec.size() ? 1 : 0);
+    if (!inBufVec.empty()) {
+        OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects(inBufVec, 0 /* 0 means from host*/, nullptr, &uploads[0]));
+    }
+    std::vector<cl::Event> phases(schedule.size());
+    for (size_t phase = 0; phase < schedule.size(); phase++) {
+        OCL_CHECK(err, err = m_auction_kernel.setArg(4, schedule[phase]));
+        OCL_CHECK(err, err = m_auction_kernel.setArg(5, static_cast<cl_uchar>(phase == 0)));
+        OCL_CHECK(err, err = m_q.enqueueTask(m_auction_kernel, nullptr, &phases[phase]));
+    }
+    cl::Event download;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects({m_stars_buffer}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, &download));
+    m_bytes_from_device += sizeof(cl_int) * size;
+    OCL_CHECK(err, err = m_q.finish());
+
+    for (const cl::Event &upload : uploads) {
+        m_transfer_ns += elapsed_ns(upload, "transfer", "upload");
+    }
+    for (const cl::Event &phase : phases) {
+        m_kernel_ns += elapsed_ns(phase, "kernel", "auction_kernel");
+    }
+    elapsed_ns(download, "transfer", "download assignment");
+    m_auction_launches += schedule.size();
+    m_auction_slack = std::max(m_auction_slack, schedule.back() / unit / 2);
+
+    std::copy(m_mapped_stars, m_mapped_stars + size, stars);
+}
+
+bool OpenClBackend::solve_from_stars(int *stars) {
+    if (m_auction && m_state.size <= AUCTION_MAX_SIZE) {
+        auction(stars);
+        return true;
+    }
+    if (!m_whole_iteration || m_state.size > ITERATION_MAX_SIZE) {
+        return false;
+    }
+
+    cl_int err;
+    std::copy(stars, stars + m_state.size, m_mapped_stars);
+    std::vector<cl::Memory> inBufVec;
+    upload_matrix(inBufVec);
+    inBufVec.push_back(m_stars_buffer);
+    m_bytes_to_device += sizeof(cl_int) * m_state.size;
+    cl::Event upload;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects(inBufVec, 0 /* 0 means from host*/, nullptr, &upload));
+
+    cl::Event event;
+    OCL_CHECK(err, err = m_q.enqueueTask(m_iteration_kernel, nullptr, &event));
+    cl::Event download;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects({m_stars_buffer}, CL_MIGRATE_MEM_OBJECT_HOST, nullptr, &download));
+    m_bytes_from_device += sizeof(cl_int) * m_state.size;
+    OCL_CHECK(err, err = m_q.finish());
+
+    m_transfer_ns += elapsed_ns(upload, "transfer", "upload");
+    m_kernel_ns += elapsed_ns(event, "kernel", "munkres_iteration_kernel");
+    elapsed_ns(download, "transfer", "download stars");
+    m_iteration_launches++;
+
+    std::copy(m_mapped_stars, m_mapped_stars + m_state.size, stars);
+    return true;
+}
+
+bool OpenClBackend::find_uncovered_zero(size_t &row, size_t &col) {
+    cl_int err;
+    std::vector<cl::Memory> inBufVec;
+    upload_matrix(inBufVec);
+    std::vector<cl::Event> uploads(inBufVec.size() ? 1 : 0);
+    if (!inBufVec.empty()) {
+        OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects(inBufVec, 0 /* 0 means from host*/, nullptr, &uploads[0]));
+    }
+    upload_masks(uploads);
+
+    cl::Event event;
+    OCL_CHECK(err, err = m_q.enqueueTask(m_kernel, nullptr, &event));
+
+    cl::Event download;
+    OCL_CHECK(err, err = m_q.enqueueMigrateMemObjects({m_found_buffer, m_row_out_buffer, m_col_out_buffer},
+                                                      CL_MIGRATE_MEM_OBJECT_HOST, nullptr, &download));
+    m_bytes_from_device += sizeof(char) + 2 * sizeof(cl_uint);
+    OCL_CHECK(err, err = m_q.finish());
+
+    for (const cl::Event &upload : uploads) {
+        m_transfer_ns += elapsed_ns(upload, "transfer", "upload");
+    }
+    m_kernel_ns += elapsed_ns(event, "kernel", "find_uncovered_kernel");
+    elapsed_ns(download, "transfer", "download result");
+    m_launches++;
+
+    if (m_found[0]) {
+        row = m_row_out[0];
+        col = m_col_out[0];
+        return true;
+    }
+    return false;
+}
+
+void OpenClBackend::report(std::ostream &out) const {
+    const size_t launches =
+        m_launches + m_iteration_launches + m_step5_launches + m_preprocess_launches + m_auction_launches;
+    out << "Cost type: " << COST_NAME << " (" << sizeof(device_cost_t) << " bytes), largest quantization error: "
+        << m_quantizer.max_error() << ", clamped costs: " << m_quantizer.clamped() << std::endl;
+    out << "Kernel launches: " << m_launches << " find_uncovered, "
+        << m_iteration_launches << " munkres_iteration, " << m_step5_launches << " step5, "
+        << m_preprocess_launches << " preprocess, " << m_auction_launches << " auction"
+        << ", kernel time: " << m_kernel_ns / 1000000.0 << " ms"
+        << " (" << (launches ? m_kernel_ns / 1000.0 / launches : 0) << " us per launch)" << std::endl;
+    out << "Host to device transfer time: " << m_transfer_ns / 1000000.0 << " ms" << std::endl;
+    out << "Host to device: " << m_bytes_to_device << " bytes ("
+        << m_matrix_uploads << " matrix uploads), device to host: "
+        << m_bytes_from_device << " bytes" << std::endl;
+    const size_t mask_launches = m_launches + m_step5_launches;
+    if (mask_launches) {
+        out << "Covers: " << double(m_mask_bytes) / mask_launches << " bytes per launch ("
+            << double(m_unpacked_mask_bytes) / mask_launches << " as whole flag arrays)" << std::endl;
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "cost_quantizer.h"
+#include "solver_backend.h"
+#include "xcl2.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Device, context and program, programmed once and shared by every
+// OpenClBackend (OpenCL contexts and programs are thread safe).
+class OpenClDevice {
+public:
+    // The first Xilinx device.
+    explicit OpenClDevice(const std::string &xclbin);
+    // device, programmed with the xclbin image in binary.
+    OpenClDevice(const cl::Device &device, const std::vector<unsigned char> &binary);
+
+    // Every Xilinx device, each programmed once; the xclbin is read once.
+    static std::vector<std::unique_ptr<OpenClDevice>> open_all(const std::string &xclbin);
+
+    // Kernel name bound to compute unit <kernel>_<cu + 1>, or the plain
+    // kernel name when cu < 0.
+    static std::string compute_unit(const std::string &kernel, int cu);
+
+    cl::Device device;
+    cl::Context context;
+    cl::Program program;
+
+private:
+    void program_device(const cl::Device &xil_device, const std::vector<unsigned char> &binary);
+};
+
+// Largest matrix munkres_iteration_kernel holds on chip; must match
+// src/munkres_iteration.cpp. Larger ones are searched with
+// find_uncovered_kernel, which takes any size.
+constexpr size_t ITERATION_MAX_SIZE = 256;
+
+// Largest matrix preprocess_kernel keeps the minima of on chip; must
+// match src/preprocess.cpp.
+constexpr size_t PREPROCESS_MAX_SIZE = 4096;
+
+// Largest matrix auction_kernel holds on chip; must match
+// src/auction.cpp.
+constexpr size_t AUCTION_MAX_SIZE = 256;
+
+// Run time of a completed command on a profiling queue. Given a name, the
+// command is also recorded on the timeline, when tracing is enabled (see
+// timeline.h), with its queued, submit, start and end times.
+cl_ulong elapsed_ns(const cl::Event &event, const char *category = nullptr, const char *name = nullptr);
+
+// Runs steps 2 to 5 in a single launch of munkres_iteration_kernel when
+// the xclbin has it, whole_iteration is set and the matrix fits on chip
+// (ITERATION_MAX_SIZE). Otherwise searches for
+// uncovered zeros with find_uncovered_kernel, one launch per prime, and
+// runs step 5 with step5_kernel on the device resident matrix, so after
+// the first upload only the masks cross the bus; the host copy of the
+// matrix is then stale and unused. Without step5_kernel in the xclbin,
+// step 5 runs on the host (see cpu_backend.h) and the matrix is migrated
+// again after it.
+//
+// When the xclbin has preprocess_kernel, device_cost_t is double and the
+// device runs every later step that reads the matrix, the padded input is
+// uploaded as is and the device replaces the infinities, reduces and
+// stars it; only the stars of step 1 come back and the reduced matrix
+// stays on the device.
+//
+// With auction set and auction_kernel in the xclbin, matrices that fit on
+// chip (AUCTION_MAX_SIZE) skip steps 2 to 5 altogether: the reduced
+// matrix is uploaded once and auction_kernel runs one launch per phase of
+// the host's epsilon scaling (see auction_plan.h), the column prices
+// staying on the device between phases. The assignment is optimal for
+// integer costs and within n * epsilon of it otherwise, which
+// quantization_error() accounts for.
+//
+// The device sees the matrix as device_cost_t (see cost_type.h): unless
+// that is double, reduce() quantizes the reduced matrix and every upload
+// converts it, writing the quantized values back so the host steps work
+// on exactly what the device compares.
+//
+// The matrix and the stars live in buffers the runtime allocates
+// (CL_MEM_ALLOC_HOST_PTR) and that stay mapped into the host, page
+// aligned: the solver works in the mapped matrix in place, and migration
+// is the only data movement. The storage only grows, being allocated and
+// mapped again when a larger n comes; the kernels get sub-buffers of
+// exactly n x n, so only n^2 costs migrate. The matrix stays resident on
+// the device and is migrated again only after the host changed it. The row and column masks go over
+// packed, a bit per line (see cover_bits.h), and only the span of words
+// that differs from what the device holds is written; the report gives
+// the cover bytes per launch against the whole flag arrays.
+class OpenClBackend : public SolverBackend {
+public:
+    // Owns its command queue and kernel objects; cu >= 0 binds them to
+    // compute unit <kernel>_<cu + 1> (see --connectivity.nk), otherwise
+    // the runtime picks one.
+    OpenClBackend(OpenClDevice &device, int cu = -1, bool whole_iteration = true, bool auction = false);
+    ~OpenClBackend() override;
+
+    const char *name() const override { return "opencl"; }
+    MunkresState &state() override { return m_state; }
+    void resize(size_t size) override;
+    void reduce(bool rows_first) override;
+    bool reduce_and_star(bool rows_first, int *stars) override;
+    bool find_uncovered_zero(size_t &row, size_t &col) override;
+    void step5() override;
+    bool solve_from_stars(int *stars) override;
+    double quantization_error() const override { return m_quantizer.max_error() + m_auction_slack; }
+    void report(std::ostream &out) const override;
+
+private:
+    void grow(size_t size);
+    void unmap();
+    void auction(int *stars);
+    void upload_matrix(std::vector<cl::Memory> &buffers);
+    void upload_masks(std::vector<cl::Event> &events);
+    void upload_cover(const std::vector<char> &mask, std::vector<cl_uint, aligned_allocator<cl_uint>> &cover,
+                      std::vector<cl_uint> &device_cover, const cl::Buffer &buffer,
+                      std::vector<cl::Event> &events);
+
+    cl::Context m_context;
+    cl::CommandQueue m_q;
+    cl::Kernel m_kernel;
+    cl::Kernel m_iteration_kernel;
+    cl::Kernel m_step5_kernel;
+    cl::Kernel m_preprocess_kernel;
+    cl::Kernel m_auction_kernel;
+    bool m_whole_iteration = false;
+    bool m_device_step5 = false;
+    bool m_device_preprocess = false;
+    bool m_auction = false;
+
+    // Storage for the largest n so far, and where it is mapped. When
+    // device_cost_t is double the mapped matrix is the solver's working
+    // matrix; otherwise the solver works in m_matrix and the quantized
+    // costs are written straight into the mapped one.
+    size_t m_capacity = 0;
+    cl::Buffer m_matrix_store, m_stars_store;
+    device_cost_t *m_mapped_matrix = nullptr;
+    cl_int *m_mapped_stars = nullptr;
+    std::vector<double> m_matrix;
+    // The solver's masks, a flag per line.
+    std::vector<char> m_row_mask;
+    std::vector<char> m_col_mask;
+    // Packed masks, and the words as last written to the device.
+    std::vector<cl_uint, aligned_allocator<cl_uint>> m_row_cover;
+    std::vector<cl_uint, aligned_allocator<cl_uint>> m_col_cover;
+    std::vector<cl_uint> m_device_row_cover;
+    std::vector<cl_uint> m_device_col_cover;
+    bool m_covers_synced = false;
+    std::vector<cl_uint, aligned_allocator<cl_uint>> m_row_out;
+    std::vector<cl_uint, aligned_allocator<cl_uint>> m_col_out;
+    std::vector<char, aligned_allocator<char>> m_found;
+    MunkresState m_state;
+
+    cl::Buffer m_matrix_buffer, m_row_cover_buffer, m_col_cover_buffer;
+    cl::Buffer m_row_out_buffer, m_col_out_buffer, m_found_buffer, m_stars_buffer;
+    // Column prices, carried from one auction phase to the next
+    cl::Buffer m_prices_buffer;
+
+    bool m_matrix_dirty = true;
+    CostQuantizer m_quantizer;
+    size_t m_bytes_to_device = 0, m_bytes_from_device = 0;
+    size_t m_mask_bytes = 0, m_unpacked_mask_bytes = 0;
+    size_t m_launches = 0, m_iteration_launches = 0, m_step5_launches = 0, m_preprocess_launches = 0,
+           m_auction_launches = 0, m_matrix_uploads = 0;
+    // Half the last epsilon of the auctions so far, in cost units: an
+    // error per cost that bounds how far they can be from the optimum
+    double m_auction_slack = 0;
+    cl_ulong m_kernel_ns = 0, m_transfer_ns = 0;
+};
@@ -0,0 +1,242 @@
+#include "ap_int.h"
+#include "hls_stream.h"
+#include "cost_type.h"
+
+// Largest matrix the per row and column minima are kept on chip for;
+// must match PREPROCESS_MAX_SIZE in opencl_backend.h.
+#define MAX_SIZE 4096
+// Size the loop bounds are estimated for (LOOP_TRIPCOUNT only).
+#define TYPICAL_SIZE 256
+
+// Costs of the reduced matrix go to the device type as the host's
+// CostQuantizer would put them: ap_fixed and int32 are clamped to the
+// same headroom, int32 is scaled by a power of two.
+#if COST_TYPE == COST_FIXED
+static const double cost_limit = double(1 << (COST_FIXED_I - 3));
+#elif COST_TYPE == COST_INT32
+static const double cost_limit = double(1 << 29);
+#endif
+
+// Power of two bringing largest just below 2^29, like
+// CostQuantizer::set_scale() for int32.
+static double int32_scale(double largest) {
+    double scale = 1;
+    if (largest <= 0) {
+        return scale;
+    }
+    grow: for (int i = 0; i < 64 && largest * scale * 2 < (1 << 29); i++) {
+        scale *= 2;
+    }
+    shrink: for (int i = 0; i < 64 && largest * scale >= (1 << 29); i++) {
+        scale /= 2;
+    }
+    return scale;
+}
+
+static cost_t to_cost(double value, double scale) {
+#pragma HLS INLINE
+#if COST_TYPE == COST_FIXED
+    (void)scale;
+    return cost_t(value < cost_limit ? value : cost_limit);
+#elif COST_TYPE == COST_INT32
+    const double scaled = value * scale;
+    return cost_t((scaled < cost_limit ? scaled : cost_limit) + 0.5);
+#else
+    (void)scale;
+    return cost_t(value);
+#endif
+}
+
+static bool is_infinite(double value) {
+#pragma HLS INLINE
+    return value > 1.7976931348623157e308;
+}
+
+// Reads the size x size input from global memory into in.
+static void read_input(const double *input, hls::stream<double> &in, ap_uint<32> size) {
+    mem_rd: for (ap_uint<32> i = 0; i < size * size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE * TYPICAL_SIZE
+        in << input[i];
+    }
+}
+
+// Pass 1: largest finite cost, and the minimum of every row (every column
+// when !rows_first) over the finite costs. has_finite records whether a
+// row (column) had any; its minimum is resolved once the largest cost is
+// known.
+static void scan_finite(hls::stream<double> &in, ap_uint<32> size, bool rows_first, double first_min[MAX_SIZE],
+                        bool has_finite[MAX_SIZE], double &largest, bool &any_finite) {
+    largest = 0;
+    any_finite = false;
+    init_scan: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE
+        first_min[i] = 0;
+        has_finite[i] = false;
+    }
+    scan: for (ap_uint<32> i = 0; i < size * size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE * TYPICAL_SIZE
+        const double value = in.read();
+        const ap_uint<32> line = rows_first ? ap_uint<32>(i / size) : ap_uint<32>(i % size);
+        if (!is_infinite(value)) {
+            largest = (!any_finite || value > largest) ? value : largest;
+            any_finite = true;
+            first_min[line] = (!has_finite[line] || value < first_min[line]) ? value : first_min[line];
+            has_finite[line] = true;
+        }
+    }
+}
+
+// Pass 2: substitutes infinities, subtracts the first minima and takes
+// the minimum of every column (row) of the result.
+static void reduce_first(hls::stream<double> &in, ap_uint<32> size, bool rows_first, double substitute,
+                         const double first_min[MAX_SIZE], double second_min[MAX_SIZE]) {
+    reduce: for (ap_uint<32> i = 0; i < size * size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE * TYPICAL_SIZE
+        const ap_uint<32> row = i / size, col = i % size;
+        const ap_uint<32> first = rows_first ? row : col, second = rows_first ? col : row;
+        double value = in.read();
+        value = is_infinite(value) ? substitute : value;
+        value = first_min[first] > 0 ? value - first_min[first] : value;
+        const bool starts = rows_first ? row == 0 : col == 0;
+        second_min[second] = (starts || value < second_min[second]) ? value : second_min[second];
+    }
+}
+
+// Pass 3: the reduced matrix, converted to cost_t, streams to out; as
+// its rows go by, step 1 stars the first zero of every row whose column
+// has no star yet.
+static void reduce_second(hls::stream<double> &in, hls::stream<cost_t> &out, int *stars, ap_uint<32> size,
+                          bool rows_first, double substitute, const double first_min[MAX_SIZE],
+                          const double second_min[MAX_SIZE], double scale) {
+    bool starred_col[MAX_SIZE];
+    init_stars: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE
+        starred_col[i] = false;
+    }
+
+    int star = -1;
+    finish: for (ap_uint<32> i = 0; i < size * size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE * TYPICAL_SIZE
+        const ap_uint<32> row = i / size, col = i % size;
+        const ap_uint<32> first = rows_first ? row : col, second = rows_first ? col : row;
+        double value = in.read();
+        value = is_infinite(value) ? substitute : value;
+        value = first_min[first] > 0 ? value - first_min[first] : value;
+        value = second_min[second] > 0 ? value - second_min[second] : value;
+
+        const cost_t cost = to_cost(value, scale);
+        out << cost;
+        if (col == 0) {
+            star = -1;
+        }
+        // On the converted cost, as the host stars the quantized matrix
+        if (star < 0 && cost == cost_t(0) && !starred_col[col]) {
+            star = col;
+            starred_col[col] = true;
+        }
+        if (col == size - 1) {
+            stars[row] = star;
+        }
+    }
+}
+
+// Writes the reduced matrix from out to global memory.
+static void write_result(cost_t *matrix, hls::stream<cost_t> &out, ap_uint<32> size) {
+    mem_wr: for (ap_uint<32> i = 0; i < size * size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE * TYPICAL_SIZE
+        matrix[i] = out.read();
+    }
+}
+
+static void scan_stage(const double *input, ap_uint<32> size, bool rows_first, double first_min[MAX_SIZE],
+                       bool has_finite[MAX_SIZE], double &largest, bool &any_finite) {
+    hls::stream<double> in("scan_in");
+#pragma HLS STREAM variable = in depth = 32
+#pragma HLS DATAFLOW
+    read_input(input, in, size);
+    scan_finite(in, size, rows_first, first_min, has_finite, largest, any_finite);
+}
+
+static void reduce_stage(const double *input, ap_uint<32> size, bool rows_first, double substitute,
+                         const double first_min[MAX_SIZE], double second_min[MAX_SIZE]) {
+    hls::stream<double> in("reduce_in");
+#pragma HLS STREAM variable = in depth = 32
+#pragma HLS DATAFLOW
+    read_input(input, in, size);
+    reduce_first(in, size, rows_first, substitute, first_min, second_min);
+}
+
+static void write_stage(const double *input, cost_t *matrix, int *stars, ap_uint<32> size, bool rows_first,
+                        double substitute, const double first_min[MAX_SIZE], const double second_min[MAX_SIZE],
+                        double scale) {
+    hls::stream<double> in("write_in");
+    hls::stream<cost_t> out("write_out");
+#pragma HLS STREAM variable = in depth = 32
+#pragma HLS STREAM variable = out depth = 32
+#pragma HLS DATAFLOW
+    read_input(input, in, size);
+    reduce_second(in, out, stars, size, rows_first, substitute, first_min, second_min, scale);
+    write_result(matrix, out, size);
+}
+
+extern "C" {
+
+// Prepares a padded size x size cost matrix on the device, as the host's
+// reduce() and step 1 would: infinities become the largest finite cost
+// plus one (0 when there is none), then the positive minimum of every row
+// and of every column is subtracted, columns first unless rows_first.
+//
+// Each of the three passes streams the input from global memory through
+// a read -> compute -> write dataflow, so only the minima (2 x size
+// values) are held on chip. The reduced matrix is written to matrix,
+// ready for munkres_iteration_kernel, find_uncovered_kernel and
+// step5_kernel, and stars receives the starred column of every row (-1
+// for none). With a double cost_t, matrix may be the input buffer itself:
+// the last pass reads every cost before it writes it back.
+void preprocess_kernel(
+    const double *input,
+    cost_t *matrix,
+    int *stars,
+    ap_uint<32> size,
+    bool rows_first
+) {
+#pragma HLS INTERFACE m_axi port = input offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = matrix offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = stars offset = slave bundle = gmem
+#pragma HLS INTERFACE s_axilite port = size bundle = control
+#pragma HLS INTERFACE s_axilite port = rows_first bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    static double first_min[MAX_SIZE];
+    static double second_min[MAX_SIZE];
+    static bool has_finite[MAX_SIZE];
+
+    double largest = 0;
+    bool any_finite = false;
+    scan_stage(input, size, rows_first, first_min, has_finite, largest, any_finite);
+
+    const double substitute = any_finite ? largest + 1 : 0;
+    resolve_min: for (ap_uint<32> i = 0; i < size; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE
+        if (!has_finite[i]) {
+            first_min[i] = substitute;
+        }
+    }
+
+    reduce_stage(input, size, rows_first, substitute, first_min, second_min);
+
+    // The reduced costs stay at or below the substitute: it bounds the
+    // int32 scale.
+    const double scale = int32_scale(substitute);
+    write_stage(input, matrix, stars, size, rows_first, substitute, first_min, second_min, scale);
+}
+
+}
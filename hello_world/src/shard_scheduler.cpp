@@ -0,0 +1,134 @@
+#include "shard_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+ShardScheduler::ShardScheduler(std::vector<std::unique_ptr<MunkresContext>> shards) {
+    for (auto &context : shards) {
+        m_shards.emplace_back(new Shard());
+        m_shards.back()->context = std::move(context);
+    }
+}
+
+void ShardScheduler::solve(const std::vector<AssignmentProblem> &problems,
+                           std::vector<std::vector<double>> &solutions) {
+    solutions.resize(problems.size());
+    if (m_shards.empty()) {
+        return;
+    }
+
+    // Largest first to the least loaded queue
+    std::vector<double> work(problems.size());
+    for (size_t i = 0; i < problems.size(); i++) {
+        const double n = std::max(problems[i].rows, problems[i].columns);
+        work[i] = n * n * n;
+    }
+    std::vector<size_t> order(problems.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return work[a] > work[b]; });
+    std::vector<double> queued(m_shards.size());
+    for (size_t i : order) {
+        const size_t shard = std::min_element(queued.begin(), queued.end()) - queued.begin();
+        m_shards[shard]->queue.push_back(i);
+        queued[shard] += work[i];
+    }
+
+    // A shard that fails stops; the others steal what it left queued, and
+    // its exception is rethrown once all are done.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::exception_ptr> errors(m_shards.size());
+    std::vector<std::thread> threads;
+    for (size_t shard = 0; shard < m_shards.size(); shard++) {
+        threads.emplace_back([&, shard]() {
+            try {
+                run(shard, problems, solutions);
+            } catch (...) {
+                errors[shard] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (std::exception_ptr &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_solved += problems.size();
+}
+
+bool ShardScheduler::next(size_t shard, size_t &problem) {
+    {
+        std::lock_guard<std::mutex> lock(m_shards[shard]->mutex);
+        std::deque<size_t> &own = m_shards[shard]->queue;
+        if (!own.empty()) {
+            problem = own.front();
+            own.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the smallest problem of the longest queue. Queues only shrink
+    // once solving started, so a shard finding them all empty is done.
+    for (;;) {
+        size_t victim = shard, longest = 0;
+        for (size_t other = 0; other < m_shards.size(); other++) {
+            if (other == shard) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_shards[other]->mutex);
+            if (m_shards[other]->queue.size() > longest) {
+                longest = m_shards[other]->queue.size();
+                victim = other;
+            }
+        }
+        if (victim == shard) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_shards[victim]->mutex);
+        std::deque<size_t> &theirs = m_shards[victim]->queue;
+        if (!theirs.empty()) {
+            problem = theirs.back();
+            theirs.pop_back();
+            m_shards[shard]->stolen++;
+            return true;
+        }
+    }
+}
+
+void ShardScheduler::run(size_t shard, const std::vector<AssignmentProblem> &problems,
+                         std::vector<std::vector<double>> &solutions) {
+    Shard &own = *m_shards[shard];
+    size_t i;
+    while (next(shard, i)) {
+        auto start = std::chrono::steady_clock::now();
+        solutions[i] = problems[i].costs;
+        own.context->solve(solutions[i].data(), problems[i].rows, problems[i].columns);
+        own.busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        own.solved++;
+    }
+}
+
+double ShardScheduler::quantization_error() const {
+    double error = 0;
+    for (const auto &shard : m_shards) {
+        error = std::max(error, shard->context->backend().quantization_error());
+    }
+    return error;
+}
+
+void ShardScheduler::report(std::ostream &out) const {
+    out << "Shards: " << m_solved << " matrices on " << m_shards.size() << " shards, "
+        << (m_seconds > 0 ? m_solved / m_seconds : 0) << " matrices/s" << std::endl;
+    for (size_t shard = 0; shard < m_shards.size(); shard++) {
+        const Shard &s = *m_shards[shard];
+        out << "  shard " << shard << " (" << s.context->backend().name() << "): " << s.solved << " solved, "
+            << s.stolen << " stolen, busy " << s.busy_seconds * 1000 << " ms" << std::endl;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "munkres_context.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Spreads a batch of problems over several shards, each a MunkresContext
+// with its own backend: one per device, or CPU contexts standing in for
+// devices. Every shard has its own queue and thread. The problems are
+// dealt out largest first to the shard with the least work queued (n^3
+// per problem); a shard works from the front of its queue and, once it
+// is empty, steals from the back of the longest other queue, so a slow
+// device or a bad estimate only costs the small problems at the end.
+class ShardScheduler {
+public:
+    explicit ShardScheduler(std::vector<std::unique_ptr<MunkresContext>> shards);
+
+    // solutions[i] receives problem i solved as MunkresContext::solve()
+    // leaves it. Rethrows a failing shard's exception once every shard
+    // has stopped.
+    void solve(const std::vector<AssignmentProblem> &problems, std::vector<std::vector<double>> &solutions);
+
+    size_t shards() const { return m_shards.size(); }
+    MunkresContext &context(size_t shard) { return *m_shards[shard]->context; }
+    // Problems shard solved, and how many of them it stole, over every
+    // solve() so far.
+    size_t solved(size_t shard) const { return m_shards[shard]->solved; }
+    size_t stolen(size_t shard) const { return m_shards[shard]->stolen; }
+    // Largest quantization error of any shard's backend
+    double quantization_error() const;
+    // Problems solved and stolen per shard, and the time each was busy.
+    void report(std::ostream &out) const;
+
+private:
+    struct Shard {
+        std::unique_ptr<MunkresContext> context;
+        std::mutex mutex;
+        std::deque<size_t> queue;  // indices into the problems
+        size_t solved = 0, stolen = 0;
+        double busy_seconds = 0;
+    };
+
+    void run(size_t shard, const std::vector<AssignmentProblem> &problems,
+             std::vector<std::vector<double>> &solutions);
+    bool next(size_t shard, size_t &problem);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    double m_seconds = 0;
+    size_t m_solved = 0;
+};
@@ -0,0 +1,108 @@
+// Test of ShardScheduler on CPU contexts: one shard is slowed down, so
+// the even split of equal problems leaves it a long queue that the other
+// shard must steal from, and every problem must still be solved once,
+// with the assignment a single context finds. A shard whose backend
+// throws must not take the process down: solve() rethrows once the
+// other shard has solved the rest.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cpu_backend.h"
+#include "munkres_context.h"
+#include "shard_scheduler.h"
+
+// The CPU backend, a few milliseconds slower per solve: a slow device.
+class SlowCpuBackend : public CpuBackend {
+public:
+    void resize(size_t size) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CpuBackend::resize(size);
+    }
+};
+
+// A device that fails on its first solve.
+class FailingBackend : public CpuBackend {
+public:
+    void resize(size_t) override { throw std::runtime_error("device lost"); }
+};
+
+static std::unique_ptr<MunkresContext> context(SolverBackend *backend) {
+    return std::unique_ptr<MunkresContext>(new MunkresContext(std::unique_ptr<SolverBackend>(backend)));
+}
+
+int main() {
+    const size_t count = 40, size = 8;
+    std::mt19937 generator(47);
+    std::uniform_int_distribution<int> value(0, 99);
+    std::vector<AssignmentProblem> problems(count);
+    for (AssignmentProblem &problem : problems) {
+        problem.rows = problem.columns = size;
+        problem.costs.resize(size * size);
+        for (double &cost : problem.costs) {
+            cost = value(generator);
+        }
+    }
+
+    int failures = 0;
+    MunkresContext reference(std::unique_ptr<SolverBackend>(new CpuBackend()));
+    {
+        std::vector<std::unique_ptr<MunkresContext>> shards;
+        shards.push_back(context(new SlowCpuBackend()));
+        shards.push_back(context(new CpuBackend()));
+        ShardScheduler scheduler(std::move(shards));
+        std::vector<std::vector<double>> solutions;
+        scheduler.solve(problems, solutions);
+
+        for (size_t i = 0; i < count; i++) {
+            std::vector<double> expected = problems[i].costs;
+            reference.solve(expected.data(), size, size);
+            if (solutions[i] != expected) {
+                std::cerr << "Problem " << i << ": assignment differs from a single context's" << std::endl;
+                failures++;
+            }
+        }
+        if (scheduler.solved(0) + scheduler.solved(1) != count) {
+            std::cerr << "Shards solved " << scheduler.solved(0) << " + " << scheduler.solved(1) << " of " << count
+                      << " problems" << std::endl;
+            failures++;
+        }
+        if (scheduler.stolen(1) == 0) {
+            std::cerr << "The fast shard stole nothing from the slow one" << std::endl;
+            failures++;
+        }
+        scheduler.report(std::cout);
+    }
+
+    {
+        std::vector<std::unique_ptr<MunkresContext>> shards;
+        // The other shard is the slow one, so the failing one surely starts
+        // before its queue is stolen.
+        shards.push_back(context(new FailingBackend()));
+        shards.push_back(context(new SlowCpuBackend()));
+        ShardScheduler scheduler(std::move(shards));
+        std::vector<std::vector<double>> solutions;
+        bool thrown = false;
+        try {
+            scheduler.solve(problems, solutions);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        // The failing shard's queue, less the problem it failed on, went to
+        // the other shard.
+        if (!thrown || scheduler.solved(1) != count - 1) {
+            std::cerr << "Failing shard: " << (thrown ? "rethrown" : "not rethrown") << ", "
+                      << scheduler.solved(1) << " of " << count - 1 << " problems solved by the other" << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << "TEST " << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+constexpr int NORMAL = 0;
+constexpr int STAR   = 1;
+constexpr int PRIME  = 2;
+
+// Row major size x size matrix over a backend's buffer: matrix[row][col].
+struct MatrixView {
+    double *data = nullptr;
+    size_t size = 0;
+
+    double *operator[](size_t row) const { return data + row * size; }
+};
+
+// Working memory of one solve. The matrix is dense, rows size apart, the
+// layout the kernels read.
+struct MunkresState {
+    MatrixView matrix;
+    char *row_mask = nullptr;
+    char *col_mask = nullptr;
+    size_t size = 0;
+};
+
+// The operations the host offloads, behind one interface so the solver
+// runs unchanged on the CPU reference or on a device.
+//
+// The backend owns the state it hands out with state(): the solver
+// writes the input there, then drives the backend through one solve.
+class SolverBackend {
+public:
+    virtual ~SolverBackend() {}
+
+    virtual const char *name() const = 0;
+
+    virtual MunkresState &state() = 0;
+
+    // Makes state() hold a size x size problem, growing the host (and
+    // device) buffers to fit; called before the input is written.
+    virtual void resize(size_t size) = 0;
+
+    // Called once the input is in state(): replaces infinities and
+    // subtracts the row then column minima (column then row minima
+    // when rows_first is false), and clears the masks.
+    virtual void reduce(bool rows_first) = 0;
+
+    // reduce() and step 1 in one go, on the input in state(): stars
+    // receives the starred column of each row (-1 for none). Returns
+    // false when the backend can't, the solver then calls reduce() and
+    // stars the zeros itself. Afterwards state() no longer holds the
+    // reduced matrix, so a backend only does this when the steps that
+    // follow never read it on the host.
+    virtual bool reduce_and_star(bool rows_first, int *stars) {
+        (void)rows_first;
+        (void)stars;
+        return false;
+    }
+
+    // Step 3: first uncovered zero in row major order.
+    virtual bool find_uncovered_zero(size_t &row, size_t &col) = 0;
+
+    // Step 5: h = smallest uncovered value, added to the covered rows
+    // and subtracted from the uncovered columns.
+    virtual void step5() = 0;
+
+    // Steps 2 to 5 in one go, starting from the stars of step 1: stars
+    // holds the starred column of each row (-1 for none) and receives
+    // the final assignment. Returns false when the backend can't, the
+    // solver then drives the steps above itself.
+    virtual bool solve_from_stars(int *stars) {
+        (void)stars;
+        return false;
+    }
+
+    // Largest difference between a reduced cost and the value the
+    // backend actually solved with, over all solves so far.
+    virtual double quantization_error() const {
+        return 0;
+    }
+
+    virtual void report(std::ostream &out) const {
+        (void)out;
+    }
+};
@@ -0,0 +1,239 @@
+#include "solver_service.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Largest request accepted: 8192 x 8192 costs.
+static const uint64_t MAX_ELEMENTS = uint64_t(1) << 26;
+
+static std::runtime_error socket_error(const std::string &what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+static sockaddr_un socket_address(const std::string &path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+// False on end of stream before the first byte, throws when the stream
+// ends inside the message.
+static bool read_all(int fd, void *data, size_t bytes) {
+    char *p = static_cast<char *>(data);
+    size_t done = 0;
+    while (done < bytes) {
+        const ssize_t n = ::recv(fd, p + done, bytes - done, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw socket_error("Reading from the socket");
+        }
+        if (n == 0) {
+            if (done == 0) {
+                return false;
+            }
+            throw std::runtime_error("Connection closed inside a message");
+        }
+        done += n;
+    }
+    return true;
+}
+
+static void write_all(int fd, const void *data, size_t bytes) {
+    const char *p = static_cast<const char *>(data);
+    size_t done = 0;
+    while (done < bytes) {
+        // A client gone away must not kill the service with SIGPIPE
+        const ssize_t n = ::send(fd, p + done, bytes - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw socket_error("Writing to the socket");
+        }
+        done += n;
+    }
+}
+
+SolverService::SolverService(MunkresContext &context) : m_context(context) {
+}
+
+SolverService::~SolverService() {
+    if (m_listener >= 0) {
+        ::close(m_listener);
+        ::unlink(m_path.c_str());
+    }
+}
+
+// Removes a socket at path that no service listens on any more. Throws
+// when path is something else, or a live service's socket.
+static void remove_stale_socket(const std::string &path, const sockaddr_un &address) {
+    struct stat status;
+    if (::lstat(path.c_str(), &status) < 0) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw socket_error("Checking " + path);
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        throw std::runtime_error(path + " exists and is not a socket");
+    }
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) {
+        throw socket_error("Creating a socket");
+    }
+    const bool refused = ::connect(probe, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 &&
+                         errno == ECONNREFUSED;
+    ::close(probe);
+    if (!refused) {
+        throw std::runtime_error(path + " is in use by a running service");
+    }
+    if (::unlink(path.c_str()) < 0) {
+        throw socket_error("Removing the stale socket " + path);
+    }
+}
+
+void SolverService::listen(const std::string &path) {
+    const sockaddr_un address = socket_address(path);
+    remove_stale_socket(path, address);
+    m_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listener < 0) {
+        throw socket_error("Creating the service socket");
+    }
+    if (::bind(m_listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) {
+        throw socket_error("Binding " + path);
+    }
+    m_path = path;
+    if (::listen(m_listener, 16) < 0) {
+        throw socket_error("Listening on " + path);
+    }
+}
+
+void SolverService::serve() {
+    while (!m_stopping) {
+        const int client = ::accept(m_listener, nullptr, nullptr);
+        if (client < 0 && errno == EINTR) {
+            continue;
+        }
+        if (client < 0) {
+            throw socket_error("Accepting a client");
+        }
+        // A broken client only loses its own connection.
+        try {
+            while (handle(client)) {
+            }
+        } catch (const std::runtime_error &e) {
+            std::cerr << "Client dropped: " << e.what() << std::endl;
+        }
+        ::close(client);
+    }
+}
+
+bool SolverService::handle(int client) {
+    uint32_t shape[2];
+    if (!read_all(client, shape, sizeof(shape))) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const size_t rows = shape[0], columns = shape[1];
+    if (rows == 0 && columns == 0) {
+        m_stopping = true;
+        return false;
+    }
+    if (rows == 0 || columns == 0 || uint64_t(rows) * columns > MAX_ELEMENTS) {
+        throw std::runtime_error("Bad matrix dimensions " + std::to_string(rows) + "x" + std::to_string(columns));
+    }
+
+    m_problem.resize(rows * columns);
+    read_all(client, m_problem.data(), sizeof(double) * m_problem.size());
+    m_context.solve(m_problem.data(), rows, columns);
+    write_all(client, m_problem.data(), sizeof(double) * m_problem.size());
+    const double error = m_context.backend().quantization_error();
+    write_all(client, &error, sizeof(error));
+    m_request_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+void SolverService::report(std::ostream &out) const {
+    if (m_request_ms.empty()) {
+        out << "Service: no requests" << std::endl;
+        return;
+    }
+    out << "Service: first request " << m_request_ms[0] << " ms" << std::endl;
+    log_latencies(out, "Service, steady state",
+                  std::vector<double>(m_request_ms.begin() + 1, m_request_ms.end()));
+    m_context.backend().report(out);
+}
+
+SolverClient::SolverClient(const std::string &path, int attempts) {
+    const sockaddr_un address = socket_address(path);
+    for (int attempt = 0;; attempt++) {
+        m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_socket < 0) {
+            throw socket_error("Creating the client socket");
+        }
+        if (::connect(m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0) {
+            return;
+        }
+        ::close(m_socket);
+        m_socket = -1;
+        // The service may still be programming the device
+        if (attempt + 1 >= attempts || (errno != ENOENT && errno != ECONNREFUSED)) {
+            throw socket_error("Connecting to " + path);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+SolverClient::~SolverClient() {
+    if (m_socket >= 0) {
+        ::close(m_socket);
+    }
+}
+
+double SolverClient::solve(const AssignmentProblem &problem, std::vector<double> &solution) {
+    const uint32_t shape[2] = {static_cast<uint32_t>(problem.rows), static_cast<uint32_t>(problem.columns)};
+    write_all(m_socket, shape, sizeof(shape));
+    write_all(m_socket, problem.costs.data(), sizeof(double) * problem.costs.size());
+    solution.resize(problem.costs.size());
+    double error = 0;
+    if (!read_all(m_socket, solution.data(), sizeof(double) * solution.size()) ||
+        !read_all(m_socket, &error, sizeof(error))) {
+        throw std::runtime_error("The service closed the connection");
+    }
+    return error;
+}
+
+void SolverClient::stop() {
+    const uint32_t shape[2] = {0, 0};
+    write_all(m_socket, shape, sizeof(shape));
+}
+
+void log_latencies(std::ostream &out, const char *label, std::vector<double> ms) {
+    if (ms.empty()) {
+        out << label << ": no requests" << std::endl;
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    const double mean = std::accumulate(ms.begin(), ms.end(), 0.0) / ms.size();
+    out << label << ": " << ms.size() << " requests, mean " << mean << " ms, median " << ms[ms.size() / 2]
+        << " ms, p99 " << ms[std::min(ms.size() - 1, ms.size() * 99 / 100)] << " ms" << std::endl;
+}
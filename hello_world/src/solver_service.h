@@ -0,0 +1,68 @@
+#pragma once
+
+#include "munkres_context.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Wire format on the local socket, native byte order. A request is the
+// rows and columns as two uint32, then the rows * columns costs as
+// doubles, row major; rows = columns = 0 asks the service to stop. The
+// reply is the solution as MunkresContext::solve() leaves it (rows *
+// columns doubles), then the largest quantization error of the service's
+// backend so far, a double.
+
+// Long lived solver behind a Unix domain socket: the device is programmed
+// and the kernels are created once, when the service starts, and every
+// request after that reuses the warm context and its grown buffers.
+// Clients are served one at a time, each for as many requests as it
+// sends before closing.
+class SolverService {
+public:
+    explicit SolverService(MunkresContext &context);
+    ~SolverService();
+
+    // Binds the socket at path, replacing a stale one (a socket nothing
+    // accepts on); throws std::runtime_error when it can't, or when path
+    // is another file or a running service's socket.
+    void listen(const std::string &path);
+    // Serves clients until one sends the stop request.
+    void serve();
+
+    // Request count and service latencies: the first request (buffers
+    // grown, first migration) apart from the steady state after it.
+    void report(std::ostream &out) const;
+
+private:
+    // False once the client closed the connection or asked to stop.
+    bool handle(int client);
+
+    MunkresContext &m_context;
+    std::string m_path;
+    int m_listener = -1;
+    bool m_stopping = false;
+    std::vector<double> m_problem;
+    std::vector<double> m_request_ms;
+};
+
+// One connection to a SolverService.
+class SolverClient {
+public:
+    // Connects to the service at path, retrying for about attempts * 0.1 s
+    // while it is starting; throws std::runtime_error when it can't.
+    explicit SolverClient(const std::string &path, int attempts = 50);
+    ~SolverClient();
+
+    // solution receives problem solved as MunkresContext::solve() leaves
+    // it; returns the service's quantization error.
+    double solve(const AssignmentProblem &problem, std::vector<double> &solution);
+    // Asks the service to stop once this connection closes.
+    void stop();
+
+private:
+    int m_socket = -1;
+};
+
+// Logs count, mean, median and 99th percentile of the latencies, in ms.
+void log_latencies(std::ostream &out, const char *label, std::vector<double> ms);
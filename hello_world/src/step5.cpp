@@ -0,0 +1,141 @@
+#include "ap_int.h"
+#include "cost_type.h"
+#include "cover_bits.h"
+
+// Columns held on chip at a time; wider matrices are processed tile by
+// tile. A multiple of LANES and of COVER_WORD_BITS.
+#define TILE_COLS 256
+// Columns reduced or updated per cycle; a power of two.
+#define LANES 8
+// Size the loop bounds are estimated for (LOOP_TRIPCOUNT only).
+#define TYPICAL_SIZE 1024
+
+// A candidate minimum: valid is false for covered cells.
+struct MinCandidate {
+    cost_t value;
+    bool valid;
+};
+
+static MinCandidate min_of(MinCandidate a, MinCandidate b) {
+#pragma HLS INLINE
+    if (!a.valid || (b.valid && b.value < a.value)) {
+        return b;
+    }
+    return a;
+}
+
+extern "C" {
+
+// Step 5 of the Munkres algorithm on the device resident matrix (dense,
+// rows size apart, any size): h = smallest uncovered value, added to the
+// covered rows and subtracted from the uncovered columns, in place. The
+// covers come packed, one bit per line (see cover_bits.h).
+//
+// The first pass reads only the uncovered rows and reduces LANES columns
+// per cycle through a tree of comparators; the second rewrites every
+// cell that changes, covered row and column (+h) or uncovered row and
+// column (-h), leaving the others untouched.
+void step5_kernel(
+    cost_t *matrix,
+    const ap_uint<32> *row_cover,
+    const ap_uint<32> *col_cover,
+    ap_uint<32> size
+) {
+#pragma HLS INTERFACE m_axi port = matrix offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = row_cover offset = slave bundle = gmem
+#pragma HLS INTERFACE m_axi port = col_cover offset = slave bundle = gmem
+#pragma HLS INTERFACE s_axilite port = size bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    bool local_col_mask[TILE_COLS];
+#pragma HLS ARRAY_PARTITION variable = local_col_mask cyclic factor = LANES
+    cost_t row_tile[TILE_COLS];
+#pragma HLS ARRAY_PARTITION variable = row_tile cyclic factor = LANES
+
+    MinCandidate h;
+    h.value = 0;
+    h.valid = false;
+
+    min_tiles: for (ap_uint<32> tile = 0; tile < size; tile += TILE_COLS) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE / TILE_COLS
+        const ap_uint<32> width = (size - tile < TILE_COLS) ? ap_uint<32>(size - tile) : ap_uint<32>(TILE_COLS);
+        ap_uint<32> col_word = 0;
+        unpack_min_mask: for (ap_uint<32> i = 0; i < width; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+            if (i % COVER_WORD_BITS == 0) {
+                col_word = col_cover[(tile + i) / COVER_WORD_BITS];
+            }
+            local_col_mask[i] = col_word[i % COVER_WORD_BITS];
+        }
+
+        min_rows: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE
+            if (row_cover[row / COVER_WORD_BITS][row % COVER_WORD_BITS]) {
+                continue;
+            }
+            burst_row: for (ap_uint<32> col = 0; col < width; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+                row_tile[col] = matrix[row * size + tile + col];
+            }
+            min_chunks: for (ap_uint<32> base = 0; base < width; base += LANES) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS / LANES
+                MinCandidate lane[LANES];
+#pragma HLS ARRAY_PARTITION variable = lane complete
+                load_lanes: for (int i = 0; i < LANES; i++) {
+#pragma HLS UNROLL
+                    const ap_uint<32> col = base + i;
+                    lane[i].value = row_tile[col];
+                    lane[i].valid = col < width && !local_col_mask[col];
+                }
+                // log2(LANES) levels of comparators
+                tree_levels: for (int stride = LANES / 2; stride > 0; stride /= 2) {
+#pragma HLS UNROLL
+                    tree_pairs: for (int i = 0; i < stride; i++) {
+#pragma HLS UNROLL
+                        lane[i] = min_of(lane[i], lane[i + stride]);
+                    }
+                }
+                h = min_of(h, lane[0]);
+            }
+        }
+    }
+
+    // Nothing is uncovered: the solver never asks for this, leave the
+    // matrix as it is.
+    if (!h.valid) {
+        return;
+    }
+
+    update_tiles: for (ap_uint<32> tile = 0; tile < size; tile += TILE_COLS) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE / TILE_COLS
+        const ap_uint<32> width = (size - tile < TILE_COLS) ? ap_uint<32>(size - tile) : ap_uint<32>(TILE_COLS);
+        ap_uint<32> col_word = 0;
+        unpack_update_mask: for (ap_uint<32> i = 0; i < width; i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+            if (i % COVER_WORD_BITS == 0) {
+                col_word = col_cover[(tile + i) / COVER_WORD_BITS];
+            }
+            local_col_mask[i] = col_word[i % COVER_WORD_BITS];
+        }
+
+        update_rows: for (ap_uint<32> row = 0; row < size; row++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TYPICAL_SIZE
+            const bool covered = row_cover[row / COVER_WORD_BITS][row % COVER_WORD_BITS];
+            update_cols: for (ap_uint<32> col = 0; col < width; col++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = TILE_COLS
+                // Covered row and column: +h; uncovered row and column: -h
+                if (covered == local_col_mask[col]) {
+                    const ap_uint<32> index = row * size + tile + col;
+                    matrix[index] = covered ? cost_t(matrix[index] + h.value) : cost_t(matrix[index] - h.value);
+                }
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+// C simulation testbench: compares step5_kernel with the host's step 5
+// (cpu_step5) on random matrices and masks, including sizes spanning
+// several column tiles. The costs are small integers, exact in every
+// COST_TYPE.
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ap_int.h"
+#include "cost_type.h"
+#include "cover_bits.h"
+#include "cpu_backend.h"
+
+// Largest size tried; the kernel's column tiles are 256 wide.
+const int MAX_SIZE = 600;
+
+extern "C" {
+void step5_kernel(cost_t *matrix, const ap_uint<32> *row_cover, const ap_uint<32> *col_cover, ap_uint<32> size);
+}
+
+int main() {
+    const int edge_sizes[] = {1, 2, 7, 8, 9, 255, 256, 257, 513, 600};
+    const int trials = 300;
+
+    std::mt19937 generator(41);
+    std::uniform_int_distribution<int> random_size(1, MAX_SIZE);
+    std::uniform_int_distribution<int> value(1, 1000);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    CpuBackend reference;
+    int mismatches = 0;
+    for (int trial = 0; trial < trials; trial++) {
+        const int n_edge = sizeof(edge_sizes) / sizeof(edge_sizes[0]);
+        const int size = trial < n_edge ? edge_sizes[trial] : random_size(generator);
+        const double cover_rate = unit(generator) * 0.9;
+
+        reference.resize(size);
+        MunkresState &state = reference.state();
+        std::vector<cost_t> matrix(size * size);
+        std::unique_ptr<bool[]> row_mask(new bool[size]), col_mask(new bool[size]);
+        std::vector<ap_uint<32>> row_cover(cover_words(size)), col_cover(cover_words(size));
+        for (int i = 0; i < size * size; i++) {
+            state.matrix.data[i] = value(generator);
+            matrix[i] = state.matrix.data[i];
+        }
+        for (int i = 0; i < size; i++) {
+            state.row_mask[i] = row_mask[i] = unit(generator) < cover_rate;
+            state.col_mask[i] = col_mask[i] = unit(generator) < cover_rate;
+        }
+        // The solver only runs step 5 with an uncovered cell left.
+        state.row_mask[0] = row_mask[0] = false;
+        state.col_mask[size - 1] = col_mask[size - 1] = false;
+
+        cpu_step5(state);
+        pack_covers(row_mask.get(), size, row_cover.data());
+        pack_covers(col_mask.get(), size, col_cover.data());
+        step5_kernel(matrix.data(), row_cover.data(), col_cover.data(), size);
+
+        for (int i = 0; i < size * size; i++) {
+            if (matrix[i] != cost_t(state.matrix.data[i])) {
+                std::cerr << "Trial " << trial << ", size " << size << ": cell " << i << " is " << double(matrix[i])
+                          << ", expected " << state.matrix.data[i] << std::endl;
+                mismatches++;
+                break;
+            }
+        }
+    }
+
+    std::cout << trials << " updates, " << mismatches << " mismatches" << std::endl;
+    std::cout << "TEST " << (mismatches == 0 ? "PASSED" : "FAILED") << std::endl;
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+#include "stream_pipeline.h"
+#include "cpu_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+StreamPipeline::StreamPipeline(OpenClDevice &device, size_t depth, int cu)
+    : m_context(device.context), m_slots(std::max<size_t>(depth, 1)),
+      m_host(std::unique_ptr<SolverBackend>(new CpuBackend())) {
+    cl_int err;
+    OCL_CHECK(err, m_q = cl::CommandQueue(device.context, device.device,
+                                          CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err));
+    m_kernel = cl::Kernel(device.program, OpenClDevice::compute_unit("munkres_iteration_kernel", cu).c_str(), &err);
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Streaming needs munkres_iteration_kernel in the xclbin");
+    }
+}
+
+void StreamPipeline::reserve(size_t size) {
+    if (size <= m_capacity) {
+        return;
+    }
+    cl_int err;
+    m_capacity = size;
+    m_stars.resize(size);
+    for (Slot &slot : m_slots) {
+        slot.matrix.resize(size * size);
+        slot.stars.resize(size);
+        OCL_CHECK(err, slot.matrix_buffer = cl::Buffer(m_context, CL_MEM_READ_ONLY,
+            sizeof(device_cost_t) * size * size, nullptr, &err));
+        OCL_CHECK(err, slot.stars_buffer = cl::Buffer(m_context, CL_MEM_READ_WRITE,
+            sizeof(cl_int) * size, nullptr, &err));
+    }
+}
+
+void StreamPipeline::collect(Slot &slot, const std::vector<AssignmentProblem> &problems,
+                             std::vector<std::vector<double>> &solutions) {
+    cl_int err;
+    OCL_CHECK(err, err = slot.read.wait());
+    m_write_ns += elapsed_ns(slot.write, "transfer", "write");
+    m_kernel_ns += elapsed_ns(slot.run, "kernel", "munkres_iteration_kernel");
+    m_read_ns += elapsed_ns(slot.read, "transfer", "read");
+
+    const AssignmentProblem &problem = problems[slot.problem];
+    solutions[slot.problem].resize(problem.costs.size());
+    MunkresContext::finish(slot.stars.data(), solutions[slot.problem].data(), problem.rows, problem.columns);
+    slot.busy = false;
+    m_solved++;
+}
+
+void StreamPipeline::solve(const std::vector<AssignmentProblem> &problems,
+                           std::vector<std::vector<double>> &solutions) {
+    cl_int err;
+    solutions.resize(problems.size());
+    auto start = std::chrono::steady_clock::now();
+
+    size_t largest = 0;
+    for (const AssignmentProblem &problem : problems) {
+        largest = std::max(largest, std::max(problem.rows, problem.columns));
+    }
+    if (largest > ITERATION_MAX_SIZE) {
+        throw std::runtime_error("Streamed matrices must fit munkres_iteration_kernel");
+    }
+    // Slots are only resized while none is in flight
+    reserve(largest);
+
+    for (size_t k = 0; k < problems.size(); k++) {
+        Slot &slot = m_slots[k % m_slots.size()];
+        // The slot's host memory is copied from and read into: reuse it
+        // only once the previous matrix in it has been read back.
+        if (slot.busy) {
+            collect(slot, problems, solutions);
+        }
+
+        auto prepare_start = std::chrono::steady_clock::now();
+        const AssignmentProblem &problem = problems[k];
+        m_host.prepare(problem.costs.data(), problem.rows, problem.columns, m_stars.data());
+        MunkresState &state = m_host.backend().state();
+        m_quantizer.set_scale(state);
+        m_quantizer.quantize(state, slot.matrix.data(), true);
+        std::copy(m_stars.begin(), m_stars.begin() + state.size, slot.stars.begin());
+        m_prepare_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - prepare_start).count();
+
+        OCL_CHECK(err, err = m_kernel.setArg(0, slot.matrix_buffer));
+        OCL_CHECK(err, err = m_kernel.setArg(1, slot.stars_buffer));
+        OCL_CHECK(err, err = m_kernel.setArg(2, static_cast<cl_uint>(state.size)));
+
+        // write -> run -> read; on an out of order queue only these
+        // dependencies order the commands, so the write of this slot
+        // overlaps the kernel and the read of the others. Only the n x n
+        // matrix and n stars are copied.
+        const size_t size = state.size;
+        cl::Event stars_written;
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(slot.matrix_buffer, CL_FALSE, 0, sizeof(device_cost_t) * size * size,
+                                                    slot.matrix.data(), nullptr, &slot.write));
+        OCL_CHECK(err, err = m_q.enqueueWriteBuffer(slot.stars_buffer, CL_FALSE, 0, sizeof(cl_int) * size,
+                                                    slot.stars.data(), nullptr, &stars_written));
+        std::vector<cl::Event> write_done{slot.write, stars_written};
+        OCL_CHECK(err, err = m_q.enqueueTask(m_kernel, &write_done, &slot.run));
+        std::vector<cl::Event> run_done{slot.run};
+        OCL_CHECK(err, err = m_q.enqueueReadBuffer(slot.stars_buffer, CL_FALSE, 0, sizeof(cl_int) * size,
+                                                   slot.stars.data(), &run_done, &slot.read));
+        OCL_CHECK(err, err = m_q.flush());
+        slot.problem = k;
+        slot.busy = true;
+    }
+
+    // Drain the slots oldest first
+    for (size_t k = problems.size() > m_slots.size() ? problems.size() - m_slots.size() : 0; k < problems.size(); k++) {
+        Slot &slot = m_slots[k % m_slots.size()];
+        if (slot.busy) {
+            collect(slot, problems, solutions);
+        }
+    }
+
+    m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void StreamPipeline::report(std::ostream &out) const {
+    out << "Stream: " << m_solved << " matrices through " << m_slots.size() << " slots, "
+        << (m_seconds > 0 ? m_solved / m_seconds : 0) << " matrices/s sustained" << std::endl;
+    out << "Busy time: host prepare " << m_prepare_seconds * 1000 << " ms, write " << m_write_ns / 1000000.0
+        << " ms, kernel " << m_kernel_ns / 1000000.0 << " ms, read " << m_read_ns / 1000000.0
+        << " ms, wall " << m_seconds * 1000 << " ms" << std::endl;
+    out << "Cost type: " << COST_NAME << ", largest quantization error: " << m_quantizer.max_error() << std::endl;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cost_quantizer.h"
+#include "munkres_context.h"
+#include "opencl_backend.h"
+
+#include <vector>
+
+// Solves a stream of assignment problems with munkres_iteration_kernel,
+// keeping depth of them in flight on an out of order command queue:
+// while matrix k solves, the host prepares matrix k + 1 and migrates it
+// into the next slot, and the stars of matrix k - 1 migrate back. Events
+// chain each slot's write, kernel and read; a slot is reused once its
+// read has completed. The slot buffers are sized to the largest matrix
+// of the stream and only its n x n costs and n stars are copied.
+class StreamPipeline {
+public:
+    StreamPipeline(OpenClDevice &device, size_t depth = 2, int cu = -1);
+
+    // solutions[i] receives problem i solved as MunkresContext::solve()
+    // leaves it: 0 for assigned pairs, -1 elsewhere. Every problem must
+    // fit munkres_iteration_kernel (ITERATION_MAX_SIZE).
+    void solve(const std::vector<AssignmentProblem> &problems, std::vector<std::vector<double>> &solutions);
+
+    double quantization_error() const { return m_quantizer.max_error(); }
+    void report(std::ostream &out) const;
+
+private:
+    struct Slot {
+        std::vector<device_cost_t, aligned_allocator<device_cost_t>> matrix;
+        std::vector<cl_int, aligned_allocator<cl_int>> stars;
+        cl::Buffer matrix_buffer, stars_buffer;
+        cl::Event write, run, read;
+        size_t problem = 0;
+        bool busy = false;
+    };
+
+    void reserve(size_t size);
+    void collect(Slot &slot, const std::vector<AssignmentProblem> &problems,
+                 std::vector<std::vector<double>> &solutions);
+
+    cl::Context m_context;
+    cl::CommandQueue m_q;
+    cl::Kernel m_kernel;
+    std::vector<Slot> m_slots;
+    size_t m_capacity = 0;
+
+    // Pads, reduces and stars the input on the host (CPU backend).
+    MunkresContext m_host;
+    CostQuantizer m_quantizer;
+    std::vector<int> m_stars;
+
+    size_t m_solved = 0;
+    double m_seconds = 0, m_prepare_seconds = 0;
+    cl_ulong m_write_ns = 0, m_kernel_ns = 0, m_read_ns = 0;
+};
@@ -0,0 +1,154 @@
+#include "timeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+static std::atomic<Timeline *> g_timeline{nullptr};
+
+Timeline *timeline() {
+    return g_timeline.load(std::memory_order_acquire);
+}
+
+void set_timeline(Timeline *timeline) {
+    g_timeline.store(timeline, std::memory_order_release);
+}
+
+Timeline::Timeline(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)), m_slots(new Slot[m_capacity]),
+      m_device_offset(std::numeric_limits<int64_t>::max()) {
+}
+
+uint64_t Timeline::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t Timeline::thread_id() {
+    static std::atomic<uint32_t> next{0};
+    thread_local const uint32_t id = next.fetch_add(1);
+    return id;
+}
+
+void Timeline::record(const TimelineEvent &event) {
+    const uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[index % m_capacity];
+    slot.sequence.store(0, std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Timeline::observe_device_clock(uint64_t end_ns, uint64_t host_ns) {
+    const int64_t offset = static_cast<int64_t>(host_ns - end_ns);
+    int64_t known = m_device_offset.load(std::memory_order_relaxed);
+    while (offset < known && !m_device_offset.compare_exchange_weak(known, offset, std::memory_order_relaxed)) {
+    }
+}
+
+template <typename Visit>
+void Timeline::for_each(Visit visit) const {
+    const uint64_t next = m_next.load(std::memory_order_acquire);
+    const uint64_t first = next > m_capacity ? next - m_capacity : 0;
+    const int64_t known = m_device_offset.load(std::memory_order_relaxed);
+    const int64_t offset = known == std::numeric_limits<int64_t>::max() ? 0 : known;
+    for (uint64_t index = first; index < next; index++) {
+        const Slot &slot = m_slots[index % m_capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        TimelineEvent event = slot.event;
+        if (event.device) {
+            event.queued_ns += offset;
+            event.submit_ns += offset;
+            event.start_ns += offset;
+            event.end_ns += offset;
+        }
+        visit(event);
+    }
+}
+
+// Escapes the few characters of a name JSON would choke on.
+static void write_json_string(std::ostream &out, const char *text) {
+    out << '"';
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+void Timeline::write_chrome_trace(std::ostream &out) const {
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    for_each([&](const TimelineEvent &event) { origin = std::min(origin, event.start_ns); });
+
+    // Complete ("X") events in microseconds; the host is process 0 and
+    // the device process 1, one track per recording thread.
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"host\"}},";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"device\"}}";
+    for_each([&](const TimelineEvent &event) {
+        out << ",\n{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"cat\":";
+        write_json_string(out, event.category);
+        out << ",\"ph\":\"X\",\"pid\":" << (event.device ? 1 : 0) << ",\"tid\":" << event.thread
+            << ",\"ts\":" << (event.start_ns - origin) / 1000.0 << ",\"dur\":" << (event.end_ns - event.start_ns) / 1000.0;
+        if (event.device) {
+            // How long the command waited before it was submitted, and
+            // before it started
+            out << ",\"args\":{\"queued_us\":" << (event.submit_ns - event.queued_ns) / 1000.0
+                << ",\"submitted_us\":" << (event.start_ns - event.submit_ns) / 1000.0 << "}";
+        }
+        out << "}";
+    });
+    out << "\n]}\n";
+}
+
+void Timeline::summarize(std::ostream &out) const {
+    uint64_t transfer = 0, kernel = 0, steps = 0, solves = 0;
+    size_t events = 0;
+    for_each([&](const TimelineEvent &event) {
+        const uint64_t duration = event.end_ns - event.start_ns;
+        events++;
+        if (std::strcmp(event.category, "transfer") == 0) {
+            transfer += duration;
+        } else if (std::strcmp(event.category, "kernel") == 0) {
+            kernel += duration;
+        } else if (std::strcmp(event.name, "solve") == 0) {
+            solves += duration;
+        } else {
+            steps += duration;
+        }
+    });
+    const uint64_t next = m_next.load(std::memory_order_acquire);
+    out << "Timeline: " << events << " events (" << (next > m_capacity ? next - m_capacity : 0) << " dropped), "
+        << transfer / 1e6 << " ms transfers, " << kernel / 1e6 << " ms kernels, " << steps / 1e6
+        << " ms host steps" << std::endl;
+    if (solves) {
+        const uint64_t device = transfer + kernel;
+        out << "Timeline: " << solves / 1e6 << " ms solving, " << (solves > device ? solves - device : 0) / 1e6
+            << " ms of it not on the device" << std::endl;
+    }
+}
+
+TimelineScope::TimelineScope(const char *name)
+    : m_timeline(timeline()), m_name(name) {
+    if (m_timeline) {
+        m_start_ns = Timeline::now_ns();
+    }
+}
+
+TimelineScope::~TimelineScope() {
+    if (m_timeline) {
+        TimelineEvent event;
+        event.name = m_name;
+        event.category = "host";
+        event.thread = Timeline::thread_id();
+        event.start_ns = m_start_ns;
+        event.end_ns = Timeline::now_ns();
+        m_timeline->record(event);
+    }
+}
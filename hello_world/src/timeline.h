@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+// One span of activity: a host step, or a command on the device.
+struct TimelineEvent {
+    const char *name = "";      // a string literal: only the pointer is kept
+    const char *category = "";  // "host", "transfer" or "kernel"
+    bool device = false;
+    uint32_t thread = 0;
+    // Host spans: steady clock. Device commands: the device's profiling
+    // clock, mapped onto the host's when the timeline is written.
+    uint64_t queued_ns = 0, submit_ns = 0, start_ns = 0, end_ns = 0;
+};
+
+// Fixed size ring of events that any thread records into without locks;
+// once full, the oldest events are overwritten (and counted as dropped).
+// Written out as a Chrome trace (chrome://tracing, Perfetto) once the
+// recording threads are done.
+class Timeline {
+public:
+    explicit Timeline(size_t capacity = 1 << 20);
+
+    void record(const TimelineEvent &event);
+
+    // A device command that ended at device clock end_ns was seen
+    // complete on the host at host_ns: the smallest difference seen is
+    // taken as the offset between the two clocks.
+    void observe_device_clock(uint64_t end_ns, uint64_t host_ns);
+
+    // Not safe while other threads record.
+    void write_chrome_trace(std::ostream &out) const;
+    // Time per category, and the solve time not spent on the device.
+    void summarize(std::ostream &out) const;
+
+    static uint64_t now_ns();
+    // Small, stable id of the calling thread.
+    static uint32_t thread_id();
+
+private:
+    struct Slot {
+        // index + 1 of the event in the slot, 0 while it is written
+        std::atomic<uint64_t> sequence{0};
+        TimelineEvent event;
+    };
+
+    template <typename Visit>
+    void for_each(Visit visit) const;
+
+    size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_next{0};
+    // host clock - device clock; INT64_MAX until a command completed
+    std::atomic<int64_t> m_device_offset;
+};
+
+// The process wide timeline the solver and the backends record into;
+// null (the default) disables tracing.
+Timeline *timeline();
+void set_timeline(Timeline *timeline);
+
+// Records a host span named name, from construction to destruction,
+// when tracing is enabled.
+class TimelineScope {
+public:
+    explicit TimelineScope(const char *name);
+    ~TimelineScope();
+
+private:
+    Timeline *m_timeline;
+    const char *m_name;
+    uint64_t m_start_ns = 0;
+};
@@ -25,10 +25,17 @@ else
 	B_NAME = $(B_TEMP)/$(DEVICE)
 endif
 
-#Checks for XILINX_VITIS
+#Checks for XILINX_VITIS, unless every goal is in CPU_ONLY_GOALS
+ifeq ($(MAKECMDGOALS),)
+NEEDS_VITIS := yes
+else ifneq ($(filter-out $(CPU_ONLY_GOALS),$(MAKECMDGOALS)),)
+NEEDS_VITIS := yes
+endif
+ifdef NEEDS_VITIS
 ifndef XILINX_VITIS
 $(error XILINX_VITIS variable is not set, please set correctly and rerun)
 endif
+endif
 
 #Checks for Device Family
 ifeq ($(HOST_ARCH), aarch32)